@@ -6,6 +6,8 @@
 #include <unistd.h>
 #include <algorithm>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 using namespace std;
 
@@ -19,6 +21,7 @@ void bidirectional_stream_copy(Socket &socket) {
   ByteStream _inbound{buffer_size};
   bool _outbound_shutdown{false};
   bool _inbound_shutdown{false};
+  vector<string_view> _views{};
 
   socket.set_blocking(false);
   _input.set_blocking(false);
@@ -48,7 +51,8 @@ void bidirectional_stream_copy(Socket &socket) {
       "read from outbound byte stream into socket", socket, Direction::Out,
       [&] {
         if (_outbound.reader().bytes_buffered()) {
-          _outbound.reader().pop(socket.write(_outbound.reader().peek()));
+          _outbound.reader().peek_all(_views);
+          _outbound.reader().pop(socket.write(_views));
         }
         if (_outbound.reader().is_finished()) {
           socket.shutdown(SHUT_WR);
@@ -85,7 +89,8 @@ void bidirectional_stream_copy(Socket &socket) {
       "read from inbound byte stream into stdout", _output, Direction::Out,
       [&] {
         if (_inbound.reader().bytes_buffered()) {
-          _inbound.reader().pop(_output.write(_inbound.reader().peek()));
+          _inbound.reader().peek_all(_views);
+          _inbound.reader().pop(_output.write(_views));
         }
         if (_inbound.reader().is_finished()) {
           _output.close();
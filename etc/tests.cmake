@@ -23,9 +23,69 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_ring)
+ttest(byte_stream_peek_all)
+ttest(byte_stream_buffer)
+ttest(byte_stream_read_into)
+ttest(byte_stream_watermarks)
+ttest(byte_stream_set_capacity)
 
 add_custom_target (check0 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 32 -R 'webget|^byte_stream_')
 
+ttest(reassembler_single)
+ttest(reassembler_cap)
+ttest(reassembler_seq)
+ttest(reassembler_dup)
+ttest(reassembler_holes)
+ttest(reassembler_overlapping)
+ttest(reassembler_win)
+ttest(reassembler_buffer)
+ttest(reassembler_sack)
+ttest(reassembler_bitmap)
+ttest(reassembler_batch)
+
+add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_')
+
+ttest(wrapping_integers_cmp)
+ttest(wrapping_integers_unwrap)
+ttest(wrapping_integers_wrap)
+ttest(wrapping_integers_roundtrip)
+ttest(wrapping_integers_extra)
+
+ttest(recv_connect)
+ttest(recv_transmit)
+ttest(recv_window)
+ttest(recv_reorder)
+ttest(recv_reorder_more)
+ttest(recv_close)
+ttest(recv_special)
+ttest(recv_batch)
+ttest(recv_sack)
+ttest(recv_delayed_ack)
+ttest(recv_autotune)
+
+add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv')
+
+ttest(send_connect)
+ttest(send_transmit)
+ttest(send_retx)
+ttest(send_window)
+ttest(send_ack)
+ttest(send_close)
+ttest(send_extra)
+ttest(send_congestion)
+ttest(send_bbr)
+ttest(send_rto)
+ttest(send_pacing)
+ttest(send_fast_retx)
+ttest(send_sack)
+ttest(send_window_scaling)
+ttest(send_large_send)
+ttest(send_pmtu)
+ttest(send_next_timeout)
+
+add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send')
+
 add_custom_target (check_webget COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 32 -R 'webget')
 
 ###
@@ -45,4 +105,8 @@ set_property(TEST ${compile_name_opt} PROPERTY TIMEOUT -1)
 set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
+stest(byte_stream_spsc_speed_test)
+stest(reassembler_speed_test)
+stest(sender_speed_test)
+stest(wrapping_integers_speed_test)
 
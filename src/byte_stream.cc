@@ -1,63 +1,235 @@
 #include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <string_view>
+#include <utility>
 
 #include "byte_stream.hh"
 
 using namespace std;
 
-ByteStream::ByteStream(uint64_t capacity) : capacity_(capacity) {}
+ByteStream::ByteStream(uint64_t capacity, Storage storage)
+    : capacity_(capacity),
+      storage_(storage),
+      low_watermark_(capacity == 0 ? 0 : capacity - 1),
+      high_watermark_(capacity) {
+  if (storage_ == Storage::Ring) {
+    if (capacity_ > (uint64_t{1} << 62)) {
+      throw runtime_error("ByteStream capacity too large for ring storage");
+    }
+    const uint64_t ring_size = std::bit_ceil(std::max(capacity_, uint64_t{1}));
+    ring_.resize(ring_size);
+    ring_mask_ = ring_size - 1;
+  }
+}
+
+void ByteStream::copy_to_ring(uint64_t index, string_view data) {
+  // Copy into the ring, wrapping around its end at most once.
+  const uint64_t start = index & ring_mask_;
+  const uint64_t first = std::min(data.size(), ring_.size() - start);
+  memcpy(ring_.data() + start, data.data(), first);
+  memcpy(ring_.data(), data.data() + first, data.size() - first);
+}
+
+void ByteStream::note_pushed(uint64_t len) {
+  const bool was_empty = reader().bytes_buffered() == 0;
+  written_bytes_ += len;
+  const uint64_t buffered = reader().bytes_buffered();
+  if (buffered >= high_watermark_) {
+    above_high_watermark_ = true;
+  }
+  if (was_empty and buffered > 0 and on_readable_) {
+    on_readable_();
+  }
+}
+
+void ByteStream::note_popped() {
+  if (above_high_watermark_ and reader().bytes_buffered() <= low_watermark_) {
+    above_high_watermark_ = false;
+    if (on_writable_) {
+      on_writable_();
+    }
+  }
+}
 
 void Writer::push(string data) {
-  uint64_t data_sz = data.size();
-  uint64_t sz = std::min(data_sz, available_capacity());
-  if (sz == 0) {
+  if (storage_ == Storage::Ring) {
+    const string_view view = string_view{data}.substr(0, available_capacity());
+    copy_to_ring(written_bytes_, view);
+    note_pushed(view.size());
     return;
   }
-  if (sz < data_sz) {
-    data.resize(sz);
+  push(Buffer{std::move(data)});
+}
+
+void Writer::push(Buffer data) {
+  const uint64_t len = data.size();
+  push(std::move(data), 0, len);
+}
+
+void Writer::push(Buffer data, uint64_t offset, uint64_t len) {
+  const string_view view = string_view{data}.substr(offset, len).substr(0, available_capacity());
+  if (view.empty()) {
+    return;
   }
-  bool changed = buffer_.empty();
-  buffer_.emplace(data);
-  if (changed) {
-    buffer_first_ = buffer_.front();
+  if (storage_ == Storage::Ring) {
+    copy_to_ring(written_bytes_, view);
+  } else {
+    // The view points into the shared string, which stays put when the Buffer is moved.
+    buffer_.push_back({std::move(data), view});
+  }
+  note_pushed(view.size());
+}
+
+void Writer::close() {
+  is_closed_ = true;
+  if (on_readable_) {
+    on_readable_();
   }
-  written_bytes_ += sz;
-  // std::cout << "push " << sz << ": " << data << std::endl;
 }
 
-void Writer::close() { is_closed_ = true; }
+void Writer::set_error() {
+  is_error_ = true;
+  if (on_readable_) {
+    on_readable_();
+  }
+  if (on_writable_) {
+    on_writable_();
+  }
+}
+
+void Writer::set_watermarks(uint64_t low, uint64_t high) {
+  if (low > high) {
+    throw runtime_error("ByteStream low watermark must not exceed high watermark");
+  }
+  low_watermark_ = low;
+  high_watermark_ = high;
+  above_high_watermark_ = reader().bytes_buffered() >= high_watermark_;
+}
 
-void Writer::set_error() { is_error_ = true; }
+void Writer::on_writable(function<void()> callback) { on_writable_ = std::move(callback); }
 
 bool Writer::is_closed() const { return is_closed_; }
 
-uint64_t Writer::available_capacity() const { return capacity_ - reader().bytes_buffered(); }
+uint64_t Writer::available_capacity() const {
+  // After a shrink, more bytes than the capacity may still be buffered.
+  const uint64_t buffered = reader().bytes_buffered();
+  return capacity_ > buffered ? capacity_ - buffered : 0;
+}
+
+void Writer::set_capacity(uint64_t capacity) {
+  if (storage_ == Storage::Ring) {
+    if (capacity > (uint64_t{1} << 62)) {
+      throw runtime_error("ByteStream capacity too large for ring storage");
+    }
+    // The ring must still hold every buffered byte. Each byte keeps its stream index, so
+    // it lands at a new offset in a ring of a different size.
+    const uint64_t ring_size =
+        std::bit_ceil(std::max({capacity, reader().bytes_buffered(), uint64_t{1}}));
+    if (ring_size != ring_.size()) {
+      vector<string_view> views;
+      reader().peek_all(views);
+      vector<char> old_ring = std::exchange(ring_, vector<char>(ring_size));
+      ring_mask_ = ring_size - 1;
+      uint64_t index = read_bytes_;
+      for (const auto view : views) {
+        copy_to_ring(index, view);
+        index += view.size();
+      }
+    }
+  }
+
+  // Default watermarks follow the capacity; custom ones are clamped to it.
+  if (high_watermark_ == capacity_) {
+    high_watermark_ = capacity;
+    low_watermark_ = capacity == 0 ? 0 : capacity - 1;
+  } else {
+    high_watermark_ = std::min(high_watermark_, capacity);
+    low_watermark_ = std::min(low_watermark_, high_watermark_);
+  }
+  capacity_ = capacity;
+}
 
 uint64_t Writer::bytes_pushed() const { return written_bytes_; }
 
-string_view Reader::peek() const { return buffer_first_; }
+string_view Reader::peek() const {
+  if (storage_ == Storage::Ring) {
+    const uint64_t start = read_bytes_ & ring_mask_;
+    return {ring_.data() + start, std::min(bytes_buffered(), ring_.size() - start)};
+  }
+  return buffer_.empty() ? string_view{} : buffer_.front().view;
+}
+
+void Reader::peek_all(vector<string_view> &views, uint64_t max_len) const {
+  views.clear();
+  uint64_t remaining = std::min(max_len, bytes_buffered());
+  auto add_view = [&](string_view view) {
+    view = view.substr(0, remaining);
+    if (not view.empty()) {
+      views.push_back(view);
+      remaining -= view.size();
+    }
+  };
+
+  if (storage_ == Storage::Ring) {
+    add_view(peek());
+    add_view({ring_.data(), remaining});  // the part that wrapped around, if any
+    return;
+  }
+
+  for (auto it = buffer_.begin(); remaining > 0 and it != buffer_.end(); ++it) {
+    add_view(it->view);
+  }
+}
+
+uint64_t Reader::read_into(span<char> out) {
+  uint64_t copied = 0;
+  while (copied < out.size() and bytes_buffered() > 0) {
+    const string_view view = peek().substr(0, out.size() - copied);
+    if (view.empty()) {
+      throw runtime_error("Reader::peek() returned empty string_view");
+    }
+    memcpy(out.data() + copied, view.data(), view.size());
+    copied += view.size();
+    pop(view.size());
+  }
+  return copied;
+}
+
+void Reader::pop_all_into(string &out) {
+  const size_t old_size = out.size();
+  out.resize(old_size + bytes_buffered());
+  read_into(span{out}.subspan(old_size));
+}
+
+void Reader::on_readable(function<void()> callback) { on_readable_ = std::move(callback); }
 
 bool Reader::is_finished() const { return is_closed_ && bytes_buffered() == 0; }
 
 bool Reader::has_error() const { return is_error_; }
 
 void Reader::pop(uint64_t len) {
+  if (storage_ == Storage::Ring) {
+    read_bytes_ += std::min(len, bytes_buffered());
+    note_popped();
+    return;
+  }
   read_bytes_ += len;
   while (len > 0 && !buffer_.empty()) {
-    uint64_t sz = buffer_first_.size();
+    uint64_t sz = buffer_.front().view.size();
     if (len >= sz) {
       len -= sz;
-      buffer_.pop();
-      buffer_first_ = buffer_.front();
+      buffer_.pop_front();
     } else {
-      buffer_first_.remove_prefix(len);
+      buffer_.front().view.remove_prefix(len);
       len = 0;
     }
   }
   read_bytes_ -= len;
+  note_popped();
 }
 
 uint64_t Reader::bytes_buffered() const { return writer().bytes_pushed() - bytes_popped(); }
@@ -1,29 +1,60 @@
 #pragma once
 
+#include "buffer.hh"
+
 #include <cstdint>
 #include <deque>
-#include <queue>
+#include <functional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 class Reader;
 class Writer;
 
 class ByteStream {
+ public:
+  // How the buffered bytes are stored:
+  //   Queue: one heap-allocated string per push (the default)
+  //   Ring:  one contiguous power-of-two ring, allocated once at construction
+  enum class Storage { Queue, Ring };
+
  protected:
   uint64_t capacity_;
+  Storage storage_;
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader
   // interfaces.
-  std::queue<std::string> buffer_{};
-  std::string_view buffer_first_{};
+  // A refcounted chunk in the queue, and the part of it that has not been popped yet
+  struct Chunk {
+    Buffer data;
+    std::string_view view;
+  };
+  std::deque<Chunk> buffer_{};
   bool is_closed_{false};
   uint64_t written_bytes_{0};
   uint64_t read_bytes_{0};
   bool is_error_{false};
+  std::vector<char> ring_{};  // only used with Storage::Ring; size is a power of two
+  uint64_t ring_mask_{0};
+
+  // Watermarks: once bytes_buffered() reaches the high watermark, the Writer is "full" until
+  // pops bring it back down to the low watermark, at which point `on_writable_` fires. The
+  // Reader's `on_readable_` fires when the buffer goes from empty to non-empty, and on close or
+  // error. Both are edge-triggered, so neither side needs to be polled.
+  uint64_t low_watermark_{0};
+  uint64_t high_watermark_{0};
+  bool above_high_watermark_{false};
+  std::function<void()> on_readable_{};
+  std::function<void()> on_writable_{};
+
+  void copy_to_ring(uint64_t index, std::string_view data);  // Copy `data` to stream `index`
+  void note_pushed(uint64_t len);            // Account for `len` newly buffered bytes
+  void note_popped();                        // Check the low watermark after a pop
 
  public:
-  explicit ByteStream(uint64_t capacity);
+  explicit ByteStream(uint64_t capacity, Storage storage = Storage::Queue);
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader &reader();
@@ -36,19 +67,33 @@ class Writer : public ByteStream {
  public:
   void push(
       std::string data);  // Push data to stream, but only as much as available capacity allows.
+  void push(Buffer data);  // Push a refcounted chunk; with Queue storage it is kept, not copied
+  void push(Buffer data, uint64_t offset, uint64_t len);  // Push only data[offset, offset + len)
 
   void close();      // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error();  // Signal that the stream suffered an error.
 
   bool is_closed() const;               // Has the stream been closed?
   uint64_t available_capacity() const;  // How many bytes can be pushed to the stream right now?
+  void set_capacity(uint64_t capacity);  // Grow or shrink; bytes already buffered are kept
   uint64_t bytes_pushed() const;        // Total number of bytes cumulatively pushed to the stream
+
+  // Notify when the buffer drains to `low` bytes after having filled to `high` (default: when
+  // a full stream gets room again)
+  void set_watermarks(uint64_t low, uint64_t high);
+  void on_writable(std::function<void()> callback);
 };
 
 class Reader : public ByteStream {
  public:
-  std::string_view peek() const;  // Peek at the next bytes in the buffer
+  std::string_view peek() const;  // Peek at the next bytes in the buffer (largest contiguous span)
+  void peek_all(std::vector<std::string_view> &views,  // Replace `views` with every buffered span,
+                uint64_t max_len = UINT64_MAX) const;  // covering at most `max_len` bytes
   void pop(uint64_t len);         // Remove `len` bytes from the buffer
+  uint64_t read_into(std::span<char> out);  // Copy and pop up to out.size() bytes; returns # copied
+  void pop_all_into(std::string &out);      // Append every buffered byte to `out`, and pop them
+
+  void on_readable(std::function<void()> callback);  // Notify when data arrives or stream ends
 
   bool is_finished() const;  // Is the stream finished (closed and fully popped)?
   bool has_error() const;    // Has the stream had an error?
@@ -0,0 +1,153 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make(Algorithm algorithm, uint64_t mss) {
+  switch (algorithm) {
+    case Algorithm::None:
+      return nullptr;
+    case Algorithm::Reno:
+      return make_unique<Reno>(mss);
+    case Algorithm::NewReno:
+      return make_unique<NewReno>(mss);
+    case Algorithm::Cubic:
+      return make_unique<Cubic>(mss);
+    case Algorithm::BBR:
+      return make_unique<BBR>(mss);
+  }
+  return nullptr;
+}
+
+// The initial window is RFC 6928's ten segments (or about 14 KB, if that is fewer).
+Reno::Reno(uint64_t mss) : mss_(mss), cwnd_(min(10 * mss, max(2 * mss, uint64_t{14600}))) {}
+
+void Reno::on_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                  optional<uint64_t> rtt_ms) {
+  (void)in_flight;
+  if (cwnd_ < ssthresh_) {
+    cwnd_ += min(acked, 2 * mss_);  // Slow start, counting bytes with RFC 3465's limit
+  } else {
+    grow(acked, now_ms, rtt_ms);
+  }
+}
+
+void Reno::grow(uint64_t acked, uint64_t now_ms, optional<uint64_t> rtt_ms) {
+  (void)now_ms;
+  (void)rtt_ms;
+  acked_since_increase_ += acked;
+  if (acked_since_increase_ >= cwnd_) {
+    acked_since_increase_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+uint64_t Reno::decreased_window(uint64_t in_flight) const {
+  return max(in_flight / 2, 2 * mss_);
+}
+
+void Reno::on_enter_recovery(uint64_t in_flight, uint64_t now_ms) {
+  (void)now_ms;
+  ssthresh_ = decreased_window(in_flight);
+  cwnd_ = ssthresh_ + 3 * mss_;  // The three duplicate ACKs each mean a segment has left
+  acked_since_increase_ = 0;
+}
+
+void Reno::on_recovery_dup_ack() {
+  cwnd_ += mss_;
+}
+
+bool Reno::on_partial_ack(uint64_t acked) {
+  (void)acked;
+  return false;
+}
+
+void Reno::on_exit_recovery() {
+  cwnd_ = ssthresh_;
+}
+
+void Reno::on_timeout(uint64_t in_flight, uint64_t now_ms) {
+  (void)now_ms;
+  ssthresh_ = decreased_window(in_flight);
+  cwnd_ = mss_;  // RFC 5681's loss window
+  acked_since_increase_ = 0;
+}
+
+// Windows stay the same number of segments, as if they were counted in segments (as Linux does).
+void Reno::set_mss(uint64_t mss) {
+  cwnd_ = max(cwnd_ * mss / mss_, mss);
+  if (ssthresh_ != UINT64_MAX) {
+    ssthresh_ = max(ssthresh_ * mss / mss_, 2 * mss);
+  }
+  acked_since_increase_ = 0;
+  mss_ = mss;
+}
+
+bool NewReno::on_partial_ack(uint64_t acked) {
+  // Deflate by what was acknowledged, then add back one segment for the retransmission.
+  cwnd_ -= min(acked, cwnd_ - mss_);
+  if (acked >= mss_) {
+    cwnd_ += mss_;
+  }
+  return true;
+}
+
+uint64_t Cubic::decreased_window(uint64_t in_flight) const {
+  (void)in_flight;
+  return max(static_cast<uint64_t>(static_cast<double>(cwnd_) * BETA), 2 * mss_);
+}
+
+void Cubic::note_loss() {
+  const double w = static_cast<double>(cwnd_) / static_cast<double>(mss_);
+
+  // Fast convergence: if the window stopped short of the previous peak, a new flow is probably
+  // competing for the link, so release some bandwidth by aiming lower.
+  w_max_ = w < w_last_max_ ? w * (1 + BETA) / 2 : w;
+  w_last_max_ = w;
+  epoch_start_ms_.reset();
+}
+
+void Cubic::on_enter_recovery(uint64_t in_flight, uint64_t now_ms) {
+  note_loss();
+  NewReno::on_enter_recovery(in_flight, now_ms);
+}
+
+void Cubic::on_timeout(uint64_t in_flight, uint64_t now_ms) {
+  note_loss();
+  NewReno::on_timeout(in_flight, now_ms);
+}
+
+void Cubic::grow(uint64_t acked, uint64_t now_ms, optional<uint64_t> rtt_ms) {
+  if (rtt_ms.has_value()) {
+    min_rtt_ms_ = min(min_rtt_ms_, rtt_ms.value());
+  }
+
+  const double mss = static_cast<double>(mss_);
+  const double cwnd = static_cast<double>(cwnd_) / mss;
+  if (not epoch_start_ms_.has_value()) {
+    epoch_start_ms_ = now_ms;
+    w_est_ = cwnd;
+    if (cwnd < w_max_) {
+      k_ = cbrt((w_max_ - cwnd) / C);
+    } else {
+      k_ = 0;
+      w_max_ = cwnd;
+    }
+  }
+
+  // Aim for where the cubic function will be one RTT from now.
+  const double rtt = min_rtt_ms_ == UINT64_MAX ? 0 : static_cast<double>(min_rtt_ms_) / 1000;
+  const double t = static_cast<double>(now_ms - epoch_start_ms_.value()) / 1000 + rtt;
+  const double target = clamp(C * pow(t - k_, 3) + w_max_, cwnd, 1.5 * cwnd);
+
+  // What Reno would have grown to over the same ACKs, with CUBIC's decrease factor
+  const double segments_acked = static_cast<double>(acked) / mss;
+  w_est_ += 3 * (1 - BETA) / (1 + BETA) * segments_acked / cwnd;
+
+  const double next = w_est_ > target ? w_est_ : cwnd + (target - cwnd) / cwnd * segments_acked;
+  growth_ += (next - cwnd) * mss;
+  cwnd_ += static_cast<uint64_t>(growth_);
+  growth_ -= floor(growth_);
+}
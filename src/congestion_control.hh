@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// A delivery-rate sample (draft-cheng-iccrg-delivery-rate-estimation): `delivered` sequence
+// numbers were acknowledged over `interval_ms`, measured from the segment this ACK covered
+struct RateSample {
+  uint64_t delivered;        // Sequence numbers delivered over the interval
+  uint64_t interval_ms;      // The longer of the send and ACK intervals (never 0)
+  uint64_t prior_delivered;  // Total delivered when the ACKed segment was sent
+  bool app_limited;          // The sender ran out of data while that segment was in flight
+
+  uint64_t bytes_per_second() const { return delivered * 1000 / interval_ms; }
+};
+
+/*
+ * A congestion controller decides how many sequence numbers the TCPSender may have in flight
+ * (the congestion window, "cwnd"). The sender sends up to min(cwnd, receiver's window) and tells
+ * the controller what happens to what it sent:
+ *
+ *   - on_ack: new data was acknowledged, outside fast recovery
+ *   - on_enter_recovery: duplicate ACKs signalled a loss, and the sender fast-retransmitted
+ *   - on_recovery_dup_ack: another duplicate ACK arrived during fast recovery
+ *   - on_recovery_ack: new data was acknowledged during fast recovery (before the on_partial_ack
+ *     or on_exit_recovery for that ACK); for controllers whose model follows every ACK
+ *   - on_partial_ack: new data was acknowledged during fast recovery, but not all of it
+ *   - on_exit_recovery: everything outstanding at the start of fast recovery was acknowledged
+ *   - on_timeout: the retransmission timer expired
+ *   - on_rate_sample: an ACK yielded a delivery-rate sample (before the on_ack for that ACK)
+ *   - set_mss: the sender's MSS changed (by negotiation or path MTU probing)
+ *
+ * Window sizes are in sequence numbers (bytes), and times are the sender's clock in milliseconds.
+ */
+class CongestionControl {
+ public:
+  enum class Algorithm {
+    None,     // no congestion window: only the receiver's window limits the sender
+    Reno,     // RFC 5681 slow start, congestion avoidance, fast retransmit and fast recovery
+    NewReno,  // Reno, plus RFC 6582's handling of partial ACKs during fast recovery
+    Cubic,    // RFC 9438 CUBIC window growth, with NewReno's fast recovery
+    BBR,      // BBR: paces at the measured bottleneck bandwidth, cwnd from bandwidth x min RTT
+  };
+
+  // Make a controller for the given maximum segment size (nullptr for Algorithm::None)
+  static std::unique_ptr<CongestionControl> make(Algorithm algorithm, uint64_t mss);
+
+  virtual ~CongestionControl() = default;
+
+  virtual uint64_t window() const = 0;  // The congestion window
+
+  // How fast to send, in bytes per second, for controllers that pace (empty if unpaced)
+  virtual std::optional<uint64_t> pacing_rate() const { return {}; }
+
+  // `acked`: sequence numbers newly acknowledged; `in_flight`: what is still outstanding;
+  // `rtt_ms`: a round-trip sample from this ACK, if it gave a valid one (see Karn's algorithm)
+  virtual void on_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                      std::optional<uint64_t> rtt_ms) = 0;
+  virtual void on_enter_recovery(uint64_t in_flight, uint64_t now_ms) = 0;
+  virtual void on_recovery_dup_ack() = 0;
+  virtual void on_recovery_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                               std::optional<uint64_t> rtt_ms) {
+    (void)acked;
+    (void)in_flight;
+    (void)now_ms;
+    (void)rtt_ms;
+  }
+  virtual bool on_partial_ack(uint64_t acked) = 0;  // Returns whether fast recovery continues
+  virtual void on_exit_recovery() = 0;
+  virtual void on_timeout(uint64_t in_flight, uint64_t now_ms) = 0;
+  virtual void on_rate_sample(const RateSample &sample) { (void)sample; }
+  virtual void set_mss(uint64_t mss) = 0;
+
+ protected:
+  CongestionControl() = default;
+  CongestionControl(const CongestionControl &other) = default;
+  CongestionControl &operator=(const CongestionControl &other) = default;
+};
+
+// RFC 5681: exponential growth up to the slow-start threshold, then one MSS per window's worth of
+// ACKs. A loss halves the window; fast recovery inflates it by one MSS per duplicate ACK and
+// ends at the first ACK of new data.
+class Reno : public CongestionControl {
+ public:
+  explicit Reno(uint64_t mss);
+
+  uint64_t window() const override { return cwnd_; }
+  uint64_t slow_start_threshold() const { return ssthresh_; }
+
+  void on_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+              std::optional<uint64_t> rtt_ms) override;
+  void on_enter_recovery(uint64_t in_flight, uint64_t now_ms) override;
+  void on_recovery_dup_ack() override;
+  bool on_partial_ack(uint64_t acked) override;
+  void on_exit_recovery() override;
+  void on_timeout(uint64_t in_flight, uint64_t now_ms) override;
+  void set_mss(uint64_t mss) override;
+
+ protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_{UINT64_MAX};
+  uint64_t acked_since_increase_{};  // Congestion avoidance's byte counter (RFC 3465)
+
+  // The window to fall back to after a loss
+  virtual uint64_t decreased_window(uint64_t in_flight) const;
+  // Congestion avoidance's growth for `acked` newly acknowledged sequence numbers
+  virtual void grow(uint64_t acked, uint64_t now_ms, std::optional<uint64_t> rtt_ms);
+};
+
+// RFC 6582: a partial ACK during fast recovery means the next segment was lost too, so the sender
+// retransmits it and stays in recovery, deflating the window by what was acknowledged.
+class NewReno : public Reno {
+ public:
+  using Reno::Reno;
+
+  bool on_partial_ack(uint64_t acked) override;
+};
+
+// RFC 9438: after a loss, the window follows a cubic function of the time since, which is
+// concave up to the window where the loss happened and convex beyond it. Growth is independent
+// of the RTT, so long-haul flows recover as fast as short ones, and is never slower than Reno's.
+class Cubic : public NewReno {
+ public:
+  using NewReno::NewReno;
+
+  static constexpr double C = 0.4;     // Scaling constant, in segments/second^3
+  static constexpr double BETA = 0.7;  // Multiplicative decrease factor
+
+  void on_enter_recovery(uint64_t in_flight, uint64_t now_ms) override;
+  void on_timeout(uint64_t in_flight, uint64_t now_ms) override;
+
+ protected:
+  uint64_t decreased_window(uint64_t in_flight) const override;
+  void grow(uint64_t acked, uint64_t now_ms, std::optional<uint64_t> rtt_ms) override;
+
+ private:
+  double w_max_{};       // Window (in segments) just before the last loss
+  double w_last_max_{};  // The previous w_max_, for fast convergence
+  double w_est_{};       // Reno-friendly window estimate, in segments
+  double k_{};           // Seconds the cubic function takes to climb back to w_max_
+  std::optional<uint64_t> epoch_start_ms_{};  // When the current growth period began
+  uint64_t min_rtt_ms_{UINT64_MAX};
+  double growth_{};  // Growth (in bytes) too small to have been added to the window yet
+
+  void note_loss();
+};
+
+// BBR (version 1): rather than reacting to loss, keep a model of the path. The bottleneck
+// bandwidth is the windowed maximum of the delivery rate over the last ten rounds, and the
+// propagation delay is the minimum RTT over the last ten seconds. The sender paces at the
+// bandwidth, times a gain that cycles to probe for more, and keeps about two bandwidth-delay
+// products in flight, so the bottleneck stays busy without a standing queue.
+class BBR : public CongestionControl {
+ public:
+  enum class Mode {
+    Startup,   // Double the sending rate each round until the bandwidth stops growing
+    Drain,     // Drain the queue Startup built
+    ProbeBW,   // Cruise at the bandwidth, briefly probing above and below it each cycle
+    ProbeRTT,  // Shrink to four segments for 200 ms to re-measure the minimum RTT
+  };
+
+  static constexpr size_t BANDWIDTH_WINDOW_ROUNDS = 10;
+  static constexpr uint64_t MIN_RTT_WINDOW_MS = 10000;
+  static constexpr uint64_t PROBE_RTT_DURATION_MS = 200;
+  static constexpr double HIGH_GAIN = 2.885;  // 2/ln(2): doubles the delivery rate every round
+  static constexpr std::array<double, 8> PROBE_BW_GAINS{1.25, 0.75, 1, 1, 1, 1, 1, 1};
+
+  explicit BBR(uint64_t mss);
+
+  uint64_t window() const override { return cwnd_; }
+  std::optional<uint64_t> pacing_rate() const override;
+
+  void on_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+              std::optional<uint64_t> rtt_ms) override;
+  void on_enter_recovery(uint64_t in_flight, uint64_t now_ms) override;
+  void on_recovery_dup_ack() override {}
+  void on_recovery_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                       std::optional<uint64_t> rtt_ms) override;
+  bool on_partial_ack(uint64_t acked) override;
+  void on_exit_recovery() override;
+  void on_timeout(uint64_t in_flight, uint64_t now_ms) override;
+  void on_rate_sample(const RateSample &sample) override;
+  void set_mss(uint64_t mss) override;
+
+  Mode mode() const { return mode_; }
+  uint64_t bottleneck_bandwidth() const;  // bytes per second (0 until measured)
+  uint64_t min_rtt_ms() const { return min_rtt_ms_; }
+
+ private:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  Mode mode_{Mode::Startup};
+  double pacing_gain_{HIGH_GAIN};
+  double cwnd_gain_{HIGH_GAIN};
+
+  // Round trips, counted by delivery: a round ends when a segment sent after it began is ACKed.
+  uint64_t round_count_{};
+  uint64_t next_round_delivered_{};
+  bool round_start_{};
+
+  // The highest delivery rate seen in each of the last BANDWIDTH_WINDOW_ROUNDS rounds
+  std::array<uint64_t, BANDWIDTH_WINDOW_ROUNDS> max_rate_by_round_{};
+
+  uint64_t min_rtt_ms_{UINT64_MAX};
+  uint64_t min_rtt_stamp_ms_{};
+
+  // Startup ends once three rounds in a row fail to raise the bandwidth by a quarter.
+  uint64_t full_bandwidth_{};
+  unsigned full_bandwidth_rounds_{};
+  bool filled_pipe_{};
+
+  size_t cycle_index_{};
+  uint64_t cycle_stamp_ms_{};
+  std::optional<uint64_t> probe_rtt_done_ms_{};
+
+  bool in_recovery_{};
+  uint64_t prior_cwnd_{};  // The window to return to after recovery or ProbeRTT
+  uint64_t pacing_rate_{};
+
+  uint64_t bdp() const;  // Bandwidth-delay product, in bytes (0 until both are measured)
+  void update_mode(uint64_t in_flight, uint64_t now_ms, bool min_rtt_expired);
+  void enter_probe_bw(uint64_t now_ms);
+  void update_cwnd(uint64_t acked, uint64_t in_flight);
+};
@@ -0,0 +1,189 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+BBR::BBR(uint64_t mss) : mss_(mss), cwnd_(10 * mss) {}
+
+uint64_t BBR::bottleneck_bandwidth() const {
+  return *max_element(max_rate_by_round_.begin(), max_rate_by_round_.end());
+}
+
+uint64_t BBR::bdp() const {
+  if (min_rtt_ms_ == UINT64_MAX) {
+    return 0;
+  }
+  return bottleneck_bandwidth() * min_rtt_ms_ / 1000;
+}
+
+optional<uint64_t> BBR::pacing_rate() const {
+  if (pacing_rate_ == 0) {
+    return {};
+  }
+  return pacing_rate_;
+}
+
+void BBR::on_rate_sample(const RateSample &sample) {
+  // A segment sent after the current round began has been ACKed, so the round is over.
+  round_start_ = sample.prior_delivered >= next_round_delivered_;
+  if (round_start_) {
+    next_round_delivered_ = sample.prior_delivered + sample.delivered;
+    round_count_++;
+    max_rate_by_round_.at(round_count_ % BANDWIDTH_WINDOW_ROUNDS) = 0;
+  }
+
+  // An app-limited sample understates the bandwidth, so it only counts if it raises the maximum.
+  const uint64_t rate = sample.bytes_per_second();
+  if (not sample.app_limited or rate >= bottleneck_bandwidth()) {
+    uint64_t &slot = max_rate_by_round_.at(round_count_ % BANDWIDTH_WINDOW_ROUNDS);
+    slot = max(slot, rate);
+  }
+
+  if (not filled_pipe_ and round_start_ and not sample.app_limited) {
+    if (bottleneck_bandwidth() * 4 >= full_bandwidth_ * 5) {
+      full_bandwidth_ = bottleneck_bandwidth();
+      full_bandwidth_rounds_ = 0;
+    } else if (++full_bandwidth_rounds_ >= 3) {
+      filled_pipe_ = true;
+    }
+  }
+}
+
+void BBR::on_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                 optional<uint64_t> rtt_ms) {
+  const bool min_rtt_expired = now_ms > min_rtt_stamp_ms_ + MIN_RTT_WINDOW_MS;
+  if (rtt_ms.has_value() and (rtt_ms.value() <= min_rtt_ms_ or min_rtt_expired)) {
+    min_rtt_ms_ = rtt_ms.value();
+    min_rtt_stamp_ms_ = now_ms;
+  }
+
+  update_mode(in_flight, now_ms, min_rtt_expired);
+
+  // Until the pipe is full, the pacing rate only goes up. It starts from the initial window per
+  // RTT, since the first samples (the handshake's among them) say little about the bandwidth.
+  if (pacing_rate_ == 0 and min_rtt_ms_ != UINT64_MAX and min_rtt_ms_ > 0) {
+    pacing_rate_ = static_cast<uint64_t>(HIGH_GAIN * static_cast<double>(cwnd_ * 1000)) /
+                   min_rtt_ms_;
+  }
+  const auto rate =
+      static_cast<uint64_t>(pacing_gain_ * static_cast<double>(bottleneck_bandwidth()));
+  if (filled_pipe_ or rate > pacing_rate_) {
+    pacing_rate_ = rate;
+  }
+
+  update_cwnd(acked, in_flight);
+  round_start_ = false;
+}
+
+void BBR::update_mode(uint64_t in_flight, uint64_t now_ms, bool min_rtt_expired) {
+  if (mode_ == Mode::Startup and filled_pipe_) {
+    mode_ = Mode::Drain;
+    pacing_gain_ = 1 / HIGH_GAIN;
+    cwnd_gain_ = 1;  // BBRv1 drains by pacing alone, but the sender may not be pacing
+  }
+  if (mode_ == Mode::Drain and in_flight <= bdp()) {
+    enter_probe_bw(now_ms);
+  }
+
+  // Move to the next gain in the cycle once per min RTT. Probing up lasts until the extra data
+  // is in flight, and draining down ends early once the queue is gone.
+  if (mode_ == Mode::ProbeBW) {
+    const double gain = PROBE_BW_GAINS.at(cycle_index_);
+    const auto target = static_cast<uint64_t>(gain * static_cast<double>(bdp()));
+    const bool full_period = now_ms - cycle_stamp_ms_ > min_rtt_ms_;
+    if ((full_period and (gain <= 1 or in_flight >= target)) or
+        (gain < 1 and in_flight <= bdp())) {
+      cycle_index_ = (cycle_index_ + 1) % PROBE_BW_GAINS.size();
+      cycle_stamp_ms_ = now_ms;
+      pacing_gain_ = PROBE_BW_GAINS.at(cycle_index_);
+    }
+  }
+
+  if (mode_ != Mode::ProbeRTT and min_rtt_expired and min_rtt_ms_ != UINT64_MAX) {
+    mode_ = Mode::ProbeRTT;
+    pacing_gain_ = 1;
+    prior_cwnd_ = max(prior_cwnd_, cwnd_);
+    probe_rtt_done_ms_.reset();
+  }
+  if (mode_ == Mode::ProbeRTT) {
+    if (not probe_rtt_done_ms_.has_value() and in_flight <= 4 * mss_) {
+      probe_rtt_done_ms_ = now_ms + PROBE_RTT_DURATION_MS;
+    } else if (probe_rtt_done_ms_.has_value() and now_ms >= probe_rtt_done_ms_.value()) {
+      min_rtt_stamp_ms_ = now_ms;
+      cwnd_ = max(cwnd_, prior_cwnd_);
+      prior_cwnd_ = 0;
+      if (filled_pipe_) {
+        enter_probe_bw(now_ms);
+      } else {
+        mode_ = Mode::Startup;
+        pacing_gain_ = HIGH_GAIN;
+        cwnd_gain_ = HIGH_GAIN;
+      }
+    }
+  }
+}
+
+void BBR::enter_probe_bw(uint64_t now_ms) {
+  mode_ = Mode::ProbeBW;
+  cwnd_gain_ = 2;
+  cycle_index_ = 2;  // Start cruising; the real BBR picks a random phase other than draining
+  cycle_stamp_ms_ = now_ms;
+  pacing_gain_ = PROBE_BW_GAINS.at(cycle_index_);
+}
+
+void BBR::update_cwnd(uint64_t acked, uint64_t in_flight) {
+  if (in_recovery_) {
+    cwnd_ = max(cwnd_, in_flight + acked);  // Packet conservation: send one for each delivered
+  } else {
+    // Headroom for delayed and stretched ACKs, except while draining down to one BDP
+    const uint64_t headroom = mode_ == Mode::Drain ? 0 : 3 * mss_;
+    const auto target =
+        static_cast<uint64_t>(cwnd_gain_ * static_cast<double>(bdp())) + headroom;
+    cwnd_ = filled_pipe_ and bdp() > 0 ? min(cwnd_ + acked, target) : cwnd_ + acked;
+  }
+  cwnd_ = max(cwnd_, 4 * mss_);
+  if (mode_ == Mode::ProbeRTT) {
+    cwnd_ = min(cwnd_, 4 * mss_);
+  }
+}
+
+void BBR::on_enter_recovery(uint64_t in_flight, uint64_t now_ms) {
+  (void)now_ms;
+  prior_cwnd_ = max(prior_cwnd_, cwnd_);
+  cwnd_ = max(in_flight, mss_);
+  in_recovery_ = true;
+}
+
+// The model follows every ACK, recovery or not; only the window is handled differently (see
+// update_cwnd).
+void BBR::on_recovery_ack(uint64_t acked, uint64_t in_flight, uint64_t now_ms,
+                          optional<uint64_t> rtt_ms) {
+  on_ack(acked, in_flight, now_ms, rtt_ms);
+}
+
+bool BBR::on_partial_ack(uint64_t acked) {
+  (void)acked;
+  return true;
+}
+
+void BBR::on_exit_recovery() {
+  in_recovery_ = false;
+  cwnd_ = max(cwnd_, prior_cwnd_);
+  prior_cwnd_ = 0;
+}
+
+void BBR::on_timeout(uint64_t in_flight, uint64_t now_ms) {
+  (void)in_flight;
+  (void)now_ms;
+  in_recovery_ = false;  // The sender abandons fast recovery on a timeout.
+  cwnd_ = mss_;  // Regrows by what each ACK delivers, back up to the model's window
+}
+
+// As Reno's, the window keeps its number of segments: that is what it is until the model has a
+// bandwidth-delay product, and after that the next ACK sets it from the model again.
+void BBR::set_mss(uint64_t mss) {
+  cwnd_ = max(cwnd_ * mss / mss_, mss);
+  prior_cwnd_ = prior_cwnd_ * mss / mss_;
+  mss_ = mss;
+}
@@ -1,17 +1,205 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace std;
 
 void Reassembler::insert(uint64_t first_index, string data, bool is_last_substring,
                          Writer &output) {
-  // Your code here.
-  (void)first_index;
-  (void)data;
-  (void)is_last_substring;
-  (void)output;
+  insert(first_index, Buffer{move(data)}, is_last_substring, output);
+}
+
+void Reassembler::insert(uint64_t first_index, Buffer data, bool is_last_substring,
+                         Writer &output) {
+  Substring substring{first_index, move(data), is_last_substring};
+  insert_batch({&substring, 1}, output);
+}
+
+void Reassembler::insert_batch(span<Substring> batch, Writer &output) {
+  sort(batch.begin(), batch.end(),
+       [](const Substring &a, const Substring &b) { return a.first_index < b.first_index; });
+
+  // Keep only the part of each substring that falls inside the window the stream can accept.
+  const uint64_t first_unassembled = output.bytes_pushed();
+  const uint64_t first_unacceptable = first_unassembled + output.available_capacity();
+  first_unassembled_ = first_unassembled;
+
+  // Substrings that continue the stream in order, and overlap nothing stored, are coalesced into
+  // one run and pushed together. The rest are stored, and a single flush follows.
+  optional<Slice> run;
+  string joined;
+  uint64_t run_end = first_unassembled;
+  bool stored = false;
+
+  for (auto &[first_index, data, is_last_substring] : batch) {
+    const uint64_t size = data.size();
+    if (is_last_substring) {
+      end_index_ = first_index + size;
+    }
+
+    const uint64_t start = max(first_index, run_end);
+    const uint64_t end = min(first_index + size, first_unacceptable);
+    if (start >= end) {
+      continue;
+    }
+
+    Slice slice{move(data), start - first_index, end - start};
+    if (start == run_end and not stored and not holds_any(start, end)) {
+      if (run.has_value()) {
+        if (joined.empty()) {
+          joined = string_view{run->data}.substr(run->offset, run->len);
+        }
+        joined += string_view{slice.data}.substr(slice.offset, slice.len);
+      } else {
+        run = move(slice);
+      }
+      run_end = end;
+    } else if (engine_ == Engine::Bitmap) {
+      store_bitmap(start, slice, first_unacceptable - first_unassembled);
+      stored = true;
+    } else {
+      store(start, move(slice));
+      stored = true;
+    }
+  }
+
+  if (not joined.empty()) {
+    output.push(move(joined));
+  } else if (run.has_value()) {
+    output.push(move(run->data), run->offset, run->len);  // in order, and nothing overlaps
+  }
+  first_unassembled_ = output.bytes_pushed();
+
+  if (engine_ == Engine::Bitmap) {
+    flush_bitmap(output);
+  } else {
+    flush(output);
+  }
+
+  if (end_index_.has_value() and output.bytes_pushed() >= end_index_.value()) {
+    output.close();
+  }
+}
+
+bool Reassembler::holds_any(uint64_t begin, uint64_t end) const {
+  if (engine_ == Engine::Bitmap) {
+    return not present_.empty() and find_present(begin, end) != end;
+  }
+  return not pending_.empty() and pending_.begin()->first < end;
 }
 
-uint64_t Reassembler::bytes_pending() const {
-  // Your code here.
-  return {};
+void Reassembler::store(uint64_t start, Slice slice) {
+  const uint64_t end = start + slice.len;
+  add_range(start, end);
+  note_recent(start);
+
+  // Skip whatever the slice that starts at or before `start` already covers.
+  uint64_t pos = start;
+  auto next = pending_.upper_bound(start);
+  if (next != pending_.begin()) {
+    const auto prev = std::prev(next);
+    pos = max(pos, prev->first + prev->second.len);
+  }
+
+  // Fill each gap between `pos` and the next stored slice.
+  while (pos < end) {
+    const uint64_t gap_end = next == pending_.end() ? end : min(end, next->first);
+    if (gap_end > pos) {
+      bytes_pending_ += gap_end - pos;
+      if (pos == start and gap_end == end) {
+        pending_.emplace_hint(next, start, move(slice));  // no overlap at all
+        return;
+      }
+      pending_.emplace_hint(next, pos,
+                            Slice{slice.data, slice.offset + (pos - start), gap_end - pos});
+    }
+    if (next == pending_.end()) {
+      break;
+    }
+    pos = max(pos, next->first + next->second.len);
+    ++next;
+  }
+}
+
+void Reassembler::note_recent(uint64_t start) {
+  if (num_recent_ < recent_.size()) {
+    ++num_recent_;
+  }
+  std::shift_right(recent_.begin(), recent_.begin() + num_recent_, 1);
+  recent_.front() = start;
+}
+
+void Reassembler::add_range(uint64_t begin, uint64_t end) {
+  auto next = ranges_.upper_bound(begin);
+  auto target = ranges_.end();
+  if (next != ranges_.begin() and std::prev(next)->second >= begin) {
+    target = std::prev(next);
+    target->second = max(target->second, end);
+  } else {
+    target = ranges_.emplace_hint(next, begin, end);
+  }
+  while (next != ranges_.end() and next->first <= target->second) {
+    target->second = max(target->second, next->second);
+    next = ranges_.erase(next);
+  }
+}
+
+void Reassembler::trim_ranges(uint64_t first_unassembled) {
+  while (not ranges_.empty() and ranges_.begin()->first < first_unassembled) {
+    auto node = ranges_.extract(ranges_.begin());
+    if (node.mapped() > first_unassembled) {
+      node.key() = first_unassembled;
+      ranges_.insert(move(node));
+      return;
+    }
+  }
 }
+
+size_t Reassembler::pending_ranges(span<Range> out) const {
+  if (engine_ == Engine::Bitmap) {
+    return pending_ranges_bitmap(out);
+  }
+
+  size_t count = 0;
+  for (size_t i = 0; i < num_recent_; i++) {
+    auto it = ranges_.upper_bound(recent_[i]);
+    if (it != ranges_.begin() and std::prev(it)->second > recent_[i]) {
+      append_unique(out, count, {std::prev(it)->first, std::prev(it)->second});
+    }
+  }
+  for (auto it = ranges_.begin(); count < out.size() and it != ranges_.end(); ++it) {
+    append_unique(out, count, {it->first, it->second});
+  }
+  return count;
+}
+
+void Reassembler::append_unique(span<Range> out, size_t &count, Range range) {
+  const auto filled = out.first(count);
+  if (count < out.size() and
+      none_of(filled.begin(), filled.end(), [&](Range r) { return r.begin == range.begin; })) {
+    out[count++] = range;
+  }
+}
+
+void Reassembler::flush(Writer &output) {
+  while (not pending_.empty() and pending_.begin()->first == output.bytes_pushed()) {
+    auto node = pending_.extract(pending_.begin());
+    Slice &slice = node.mapped();
+    const uint64_t len = min(slice.len, output.available_capacity());
+    bytes_pending_ -= len;
+    if (len < slice.len) {
+      // The stream shrank since these bytes were stored; keep what no longer fits.
+      output.push(slice.data, slice.offset, len);
+      slice.offset += len;
+      slice.len -= len;
+      node.key() += len;
+      pending_.insert(move(node));
+      break;
+    }
+    output.push(move(slice.data), slice.offset, slice.len);
+  }
+  trim_ranges(output.bytes_pushed());
+}
+
+uint64_t Reassembler::bytes_pending() const { return bytes_pending_; }
@@ -1,10 +1,102 @@
 #pragma once
 
+#include "buffer.hh"
 #include "byte_stream.hh"
 
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 class Reassembler {
+ public:
+  // A range [begin, end) of stream indices
+  struct Range {
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  // How many recently received ranges pending_ranges() remembers, like TCP's SACK option
+  static constexpr size_t MAX_RECENT_RANGES = 4;
+
+  // How out-of-order bytes are stored:
+  //   Intervals: an ordered map of refcounted payload slices (the default). Costs O(log n) per
+  //              substring regardless of the window size, and never copies a payload.
+  //   Bitmap:    a byte ring covering the window plus one presence bit per byte. Bookkeeping is
+  //              a few word operations per substring, which wins for small, dense windows.
+  enum class Engine { Intervals, Bitmap };
+
+  explicit Reassembler(Engine engine = Engine::Intervals) : engine_(engine) {}
+
+  // One indexed substring, as given to insert()
+  struct Substring {
+    uint64_t first_index;
+    Buffer data;
+    bool is_last_substring;
+  };
+
+ private:
+  Engine engine_;
+
+  // A stored substring: bytes [offset, offset + len) of a refcounted payload. Slices of one
+  // payload share it, so trimming an overlap adjusts the bounds instead of copying bytes.
+  struct Slice {
+    Buffer data;
+    uint64_t offset;
+    uint64_t len;
+  };
+
+  // Bytes that arrived ahead of the first unassembled index, keyed by the index of their first
+  // byte. Stored slices never overlap: a new substring only fills the gaps between the ones
+  // already stored, so stored bytes are never copied again and locating a gap is O(log n).
+  std::map<uint64_t, Slice> pending_{};
+  uint64_t bytes_pending_{};
+  std::optional<uint64_t> end_index_{};  // One past the last byte of the stream, once known
+
+  // The stored bytes as maximal runs (begin -> end), merging slices that touch
+  std::map<uint64_t, uint64_t> ranges_{};
+
+  // Stream indices of the most recently stored substrings, newest first
+  std::array<uint64_t, MAX_RECENT_RANGES> recent_{};
+  size_t num_recent_{};
+
+  // Bitmap engine: stream index i is stored at ring_[i & ring_mask_], and bit (i & ring_mask_)
+  // of `present_` says whether it has arrived. The ring covers the window that starts at the
+  // first unassembled index.
+  std::vector<char> ring_{};
+  std::vector<uint64_t> present_{};
+  uint64_t ring_mask_{};
+  uint64_t first_unassembled_{};
+
+  void store_bitmap(uint64_t start, const Slice &slice, uint64_t window);
+  void flush_bitmap(Writer &output);
+  size_t pending_ranges_bitmap(std::span<Range> out) const;
+  void resize_ring(uint64_t window);  // Grow the ring to cover at least `window` bytes
+
+  // Presence bits over ranges of stream indices (each range must fit in the ring)
+  uint64_t set_present(uint64_t begin, uint64_t end);  // Returns how many bits were newly set
+  void clear_present(uint64_t begin, uint64_t end);
+  bool is_present(uint64_t index) const;
+  uint64_t find_absent(uint64_t begin, uint64_t end) const;       // First absent index, or `end`
+  uint64_t find_present(uint64_t begin, uint64_t end) const;      // First present index, or `end`
+  uint64_t find_run_begin(uint64_t index, uint64_t limit) const;  // Start of the run at `index`
+
+  // Are any bytes in [begin, end) stored? Only for a `begin` that nothing is stored below.
+  bool holds_any(uint64_t begin, uint64_t end) const;
+  void note_recent(uint64_t start);              // Remember a substring's index for SACK order
+  static void append_unique(std::span<Range> out, size_t &count, Range range);
+  void add_range(uint64_t begin, uint64_t end);  // Merge [begin, end) into `ranges_`
+  void trim_ranges(uint64_t first_unassembled);  // Forget ranges that have been pushed
+
+  // Store the parts of `slice` (which starts at stream index `start`) that are not already stored
+  void store(uint64_t start, Slice slice);
+
+  // Push the stored slices that continue the stream to the output
+  void flush(Writer &output);
+
  public:
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -28,6 +120,23 @@ class Reassembler {
    */
   void insert(uint64_t first_index, std::string data, bool is_last_substring, Writer &output);
 
+  // Same, but for a refcounted payload (e.g. a parsed TCP segment's). The payload is shared
+  // with the output stream rather than copied, both when it is pushed straight through and
+  // when it is stored until a gap fills.
+  void insert(uint64_t first_index, Buffer data, bool is_last_substring, Writer &output);
+
+  // Insert a burst of substrings that arrived together (e.g. from one recvmmsg or GRO batch).
+  // The batch is sorted in place by index; the substrings that continue the stream in order are
+  // coalesced into a single push to `output`, and the rest are stored before one flush. The
+  // stream receives the same bytes as if the substrings had been inserted one at a time.
+  void insert_batch(std::span<Substring> batch, Writer &output);
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
+
+  // Fill `out` with up to out.size() ranges of stored (received but unassembled) bytes, and
+  // return how many were filled. The ranges holding the most recently received substrings come
+  // first, newest first, as SACK blocks must; any remaining slots get the other ranges in stream
+  // order. Nothing is allocated, so this is cheap enough to call for every ACK.
+  size_t pending_ranges(std::span<Range> out) const;
 };
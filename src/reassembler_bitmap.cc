@@ -0,0 +1,234 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t ALL_PRESENT = ~uint64_t{0};
+
+// Mask of `n` bits (1 <= n <= 64) starting at bit `shift`
+uint64_t bit_mask(uint64_t n, uint64_t shift) {
+  return (n == 64 ? ALL_PRESENT : ((uint64_t{1} << n) - 1)) << shift;
+}
+
+// Index of the first word in words[0, n) that is not all ones, or n
+size_t first_not_full_scalar(const uint64_t *words, size_t n) {
+  size_t i = 0;
+  while (i < n and words[i] == ALL_PRESENT) {
+    ++i;
+  }
+  return i;
+}
+
+#if defined(__x86_64__)
+// SSE2 is part of x86-64, so this needs no runtime check: compare two words at a time.
+size_t first_not_full_sse2(const uint64_t *words, size_t n) {
+  const __m128i ones = _mm_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i));  // NOLINT
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, ones)) != 0xFFFF) {
+      break;
+    }
+  }
+  return i + first_not_full_scalar(words + i, n - i);
+}
+
+// Four words at a time, for CPUs that have AVX2
+__attribute__((target("avx2"))) size_t first_not_full_avx2(const uint64_t *words, size_t n) {
+  const __m256i ones = _mm256_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));  // NOLINT
+    if (not _mm256_testc_si256(v, ones)) {
+      break;
+    }
+  }
+  return i + first_not_full_scalar(words + i, n - i);
+}
+#endif
+
+size_t first_not_full(const uint64_t *words, size_t n) {
+#if defined(__x86_64__)
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2 ? first_not_full_avx2(words, n) : first_not_full_sse2(words, n);
+#else
+  return first_not_full_scalar(words, n);
+#endif
+}
+
+}  // namespace
+
+void Reassembler::store_bitmap(uint64_t start, const Slice &slice, uint64_t window) {
+  if (ring_.size() < window) {
+    resize_ring(window);
+  }
+
+  // Copy into the ring, wrapping around its end at most once.
+  const string_view data = string_view{slice.data}.substr(slice.offset, slice.len);
+  const uint64_t pos = start & ring_mask_;
+  const uint64_t first = min(static_cast<uint64_t>(data.size()), ring_.size() - pos);
+  memcpy(ring_.data() + pos, data.data(), first);
+  memcpy(ring_.data(), data.data() + first, data.size() - first);
+
+  bytes_pending_ += set_present(start, start + data.size());
+  note_recent(start);
+}
+
+void Reassembler::flush_bitmap(Writer &output) {
+  const uint64_t first = output.bytes_pushed();
+  if (not is_present(first)) {
+    return;
+  }
+
+  const uint64_t run_end = find_absent(first, first + ring_.size());
+  const uint64_t len = min(run_end - first, output.available_capacity());
+  const uint64_t pos = first & ring_mask_;
+  const uint64_t first_part = min(len, ring_.size() - pos);
+
+  string run(len, '\0');
+  memcpy(run.data(), ring_.data() + pos, first_part);
+  memcpy(run.data() + first_part, ring_.data(), len - first_part);
+
+  clear_present(first, first + len);
+  bytes_pending_ -= len;
+  output.push(move(run));
+  first_unassembled_ = output.bytes_pushed();
+}
+
+size_t Reassembler::pending_ranges_bitmap(span<Range> out) const {
+  const uint64_t window_end = first_unassembled_ + ring_.size();
+  size_t count = 0;
+
+  for (size_t i = 0; i < num_recent_; i++) {
+    const uint64_t index = recent_[i];
+    if (index >= first_unassembled_ and index < window_end and is_present(index)) {
+      append_unique(out, count,
+                    {find_run_begin(index, first_unassembled_), find_absent(index, window_end)});
+    }
+  }
+
+  for (uint64_t pos = first_unassembled_; count < out.size();) {
+    const uint64_t begin = find_present(pos, window_end);
+    if (begin == window_end) {
+      break;
+    }
+    pos = find_absent(begin, window_end);
+    append_unique(out, count, {begin, pos});
+  }
+  return count;
+}
+
+void Reassembler::resize_ring(uint64_t window) {
+  const uint64_t size = max(uint64_t{64}, bit_ceil(window));
+  const vector<char> old_ring = exchange(ring_, vector<char>(size));
+  const vector<uint64_t> old_present = exchange(present_, vector<uint64_t>(size / 64));
+  const uint64_t old_mask = exchange(ring_mask_, size - 1);
+
+  // Every stored byte keeps its stream index, so it lands at a new offset in the bigger ring.
+  for (uint64_t index = first_unassembled_; index < first_unassembled_ + old_ring.size(); ++index) {
+    const uint64_t old_pos = index & old_mask;
+    if ((old_present[old_pos / 64] >> (old_pos % 64)) & 1) {
+      ring_[index & ring_mask_] = old_ring[old_pos];
+      set_present(index, index + 1);
+    }
+  }
+}
+
+// The ring is a power of two of at least 64 bytes, so a 64-bit word of `present_` never
+// straddles its end; each loop below handles one word (or part of one) per iteration.
+
+uint64_t Reassembler::set_present(uint64_t begin, uint64_t end) {
+  uint64_t newly_set = 0;
+  while (begin < end) {
+    const uint64_t pos = begin & ring_mask_;
+    const uint64_t n = min(64 - pos % 64, end - begin);
+    const uint64_t mask = bit_mask(n, pos % 64);
+    uint64_t &word = present_[pos / 64];
+    newly_set += popcount(mask & ~word);
+    word |= mask;
+    begin += n;
+  }
+  return newly_set;
+}
+
+void Reassembler::clear_present(uint64_t begin, uint64_t end) {
+  while (begin < end) {
+    const uint64_t pos = begin & ring_mask_;
+    const uint64_t n = min(64 - pos % 64, end - begin);
+    present_[pos / 64] &= ~bit_mask(n, pos % 64);
+    begin += n;
+  }
+}
+
+bool Reassembler::is_present(uint64_t index) const {
+  if (present_.empty()) {
+    return false;
+  }
+  const uint64_t pos = index & ring_mask_;
+  return (present_[pos / 64] >> (pos % 64)) & 1;
+}
+
+uint64_t Reassembler::find_absent(uint64_t begin, uint64_t end) const {
+  while (begin < end) {
+    const uint64_t pos = begin & ring_mask_;
+    if (pos % 64 == 0 and end - begin >= 64) {
+      // Skip whole words that are fully present, as many as fit before the ring's end.
+      const uint64_t words = min(present_.size() - pos / 64, (end - begin) / 64);
+      const uint64_t full = first_not_full(present_.data() + pos / 64, words);
+      begin += full * 64;
+      if (full < words) {
+        return begin + countr_zero(~present_[pos / 64 + full]);
+      }
+      continue;
+    }
+    const uint64_t n = min(64 - pos % 64, end - begin);
+    const uint64_t missing = ~present_[pos / 64] & bit_mask(n, pos % 64);
+    if (missing) {
+      return begin + countr_zero(missing) - pos % 64;
+    }
+    begin += n;
+  }
+  return end;
+}
+
+uint64_t Reassembler::find_present(uint64_t begin, uint64_t end) const {
+  while (begin < end) {
+    const uint64_t pos = begin & ring_mask_;
+    const uint64_t n = min(64 - pos % 64, end - begin);
+    const uint64_t found = present_[pos / 64] & bit_mask(n, pos % 64);
+    if (found) {
+      return begin + countr_zero(found) - pos % 64;
+    }
+    begin += n;
+  }
+  return end;
+}
+
+uint64_t Reassembler::find_run_begin(uint64_t index, uint64_t limit) const {
+  // Walk backwards from `index` (which is present) to just after the nearest absent index.
+  while (index > limit) {
+    const uint64_t pos = (index - 1) & ring_mask_;
+    const uint64_t n = min(pos % 64 + 1, index - limit);
+    const uint64_t missing = ~present_[pos / 64] & bit_mask(n, pos % 64 + 1 - n);
+    if (missing) {
+      const uint64_t highest = 63 - countl_zero(missing);
+      return index - (pos % 64 - highest);
+    }
+    index -= n;
+  }
+  return limit;
+}
@@ -1,17 +1,78 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 using namespace std;
 
 void TCPReceiver::receive(TCPSenderMessage message, Reassembler &reassembler,
                           Writer &inbound_stream) {
-  // Your code here.
-  (void)message;
-  (void)reassembler;
-  (void)inbound_stream;
+  Reassembler::Substring substring{};
+  if (to_substring(message, inbound_stream, substring)) {
+    reassembler.insert(substring.first_index, move(substring.data), substring.is_last_substring,
+                       inbound_stream);
+  }
+}
+
+void TCPReceiver::receive_batch(span<TCPSenderMessage> messages, Reassembler &reassembler,
+                                Writer &inbound_stream) {
+  batch_.clear();
+  for (auto &message : messages) {
+    Reassembler::Substring substring{};
+    if (to_substring(message, inbound_stream, substring)) {
+      batch_.push_back(move(substring));
+    }
+  }
+  reassembler.insert_batch(batch_, inbound_stream);
+  batch_.clear();  // Don't hold on to the payloads
+}
+
+bool TCPReceiver::to_substring(TCPSenderMessage &message, const Writer &inbound_stream,
+                               Reassembler::Substring &substring) {
+  if (message.SYN and not zero_point_.has_value()) {
+    zero_point_ = message.seqno;
+  }
+  if (not zero_point_.has_value()) {
+    return false;
+  }
+
+  // The SYN occupies absolute sequence number 0, so stream index = absolute seqno - 1.
+  const uint64_t checkpoint = inbound_stream.bytes_pushed() + 1;
+  const uint64_t first_seqno = message.seqno.unwrap(zero_point_.value(), checkpoint) + message.SYN;
+  if (first_seqno == 0) {
+    return false;  // payload claims the SYN's sequence number
+  }
+
+  substring = {first_seqno - 1, move(message.payload), message.FIN};
+  return true;
 }
 
 TCPReceiverMessage TCPReceiver::send(const Writer &inbound_stream) const {
-  // Your code here.
-  (void)inbound_stream;
-  return {};
+  TCPReceiverMessage message;
+  const uint64_t max_window = uint64_t{UINT16_MAX} << window_shift_;
+  message.window_size = min(inbound_stream.available_capacity(), max_window);
+  if (zero_point_.has_value()) {
+    // The ackno counts the SYN, every byte pushed, and the FIN once the stream is closed.
+    const uint64_t next_seqno = 1 + inbound_stream.bytes_pushed() + inbound_stream.is_closed();
+    message.ackno = Wrap32::wrap(next_seqno, zero_point_.value());
+  }
+  return message;
+}
+
+TCPReceiverMessage TCPReceiver::send(const Writer &inbound_stream,
+                                     const Reassembler &reassembler) const {
+  TCPReceiverMessage message = send(inbound_stream);
+  if (not zero_point_.has_value()) {
+    return message;
+  }
+
+  array<Reassembler::Range, TCPReceiverMessage::MAX_SACK_BLOCKS> ranges{};
+  message.num_sack_blocks = reassembler.pending_ranges(ranges);
+  for (size_t i = 0; i < message.num_sack_blocks; i++) {
+    // Stream index + 1 = absolute seqno, as for the ackno
+    message.sack_blocks.at(i) = {Wrap32::wrap(ranges.at(i).begin + 1, zero_point_.value()),
+                                 Wrap32::wrap(ranges.at(i).end + 1, zero_point_.value())};
+  }
+  return message;
 }
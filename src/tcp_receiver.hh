@@ -4,6 +4,10 @@
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <optional>
+#include <span>
+#include <vector>
+
 class TCPReceiver {
  public:
   /*
@@ -12,6 +16,30 @@ class TCPReceiver {
    */
   void receive(TCPSenderMessage message, Reassembler &reassembler, Writer &inbound_stream);
 
+  /*
+   * Receive a burst of TCPSenderMessages that arrived together (e.g. from one recvmmsg or GRO
+   * batch), in arrival order. Their payloads go to the Reassembler as one batch, so in-order
+   * segments reach the inbound stream in a single push.
+   */
+  void receive_batch(std::span<TCPSenderMessage> messages, Reassembler &reassembler,
+                     Writer &inbound_stream);
+
   /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
   TCPReceiverMessage send(const Writer &inbound_stream) const;
+
+  /* Likewise, with SACK blocks for the out-of-order data the Reassembler is holding. */
+  TCPReceiverMessage send(const Writer &inbound_stream, const Reassembler &reassembler) const;
+
+  /* Allow windows up to UINT16_MAX << shift, once RFC 7323 window scaling has been agreed. */
+  void set_window_scale(uint8_t shift) { window_shift_ = shift; }
+
+ private:
+  std::optional<Wrap32> zero_point_{};  // The ISN, once a SYN has arrived
+  uint8_t window_shift_{};
+
+  // Converts a message to a Reassembler substring, or returns false if it can't be placed yet
+  bool to_substring(TCPSenderMessage &message, const Writer &inbound_stream,
+                    Reassembler::Substring &substring);
+
+  std::vector<Reassembler::Substring> batch_{};  // Reused by receive_batch()
 };
@@ -1,6 +1,7 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <random>
 
 using namespace std;
@@ -9,37 +10,571 @@ using namespace std;
 TCPSender::TCPSender(uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn)
     : isn_(fixed_isn.value_or(Wrap32{random_device()()})), initial_RTO_ms_(initial_RTO_ms) {}
 
+TCPSender::TCPSender(const TCPConfig &config) : TCPSender(config.rt_timeout, config.fixed_isn) {
+  congestion_control_ =
+      CongestionControl::make(config.congestion_control, TCPConfig::MAX_PAYLOAD_SIZE);
+  fast_retransmit_ = config.fast_retransmit;
+  large_send_ = config.large_send;
+  pmtu_probing_ = config.pmtu_probing;
+  pacing_ = config.pacing;
+  configured_pacing_rate_ = config.pacing_rate;
+  if (config.rtt_estimation) {
+    rtt_estimation_ = true;
+    RTO_min_ms_ = config.rto_min_ms;
+    RTO_max_ms_ = config.rto_max_ms;
+    RTO_ms_ = base_RTO_ms();
+  }
+}
+
 uint64_t TCPSender::sequence_numbers_in_flight() const {
-  // Your code here.
-  return {};
+  return next_seqno_ - acked_seqno_;
 }
 
 uint64_t TCPSender::consecutive_retransmissions() const {
-  // Your code here.
-  return {};
+  return consecutive_retransmissions_;
+}
+
+uint64_t TCPSender::congestion_window() const {
+  return congestion_control_ ? congestion_control_->window() : UINT64_MAX;
+}
+
+optional<uint64_t> TCPSender::smoothed_RTT_ms() const {
+  if (not SRTT_us_.has_value()) {
+    return {};
+  }
+  return SRTT_us_.value() / 1000;
+}
+
+uint64_t TCPSender::RTO_ms() const {
+  return RTO_ms_;
+}
+
+// RFC 6298: the first sample sets SRTT = R and RTTVAR = R/2; later ones move RTTVAR by 1/4 of
+// |SRTT - R| and SRTT by 1/8 of R. RTO = SRTT + max(G, 4 * RTTVAR), with G (the clock's
+// granularity) 1 ms.
+void TCPSender::note_rtt(uint64_t rtt_ms) {
+  const uint64_t rtt_us = rtt_ms * 1000;
+  if (not SRTT_us_.has_value()) {
+    SRTT_us_ = rtt_us;
+    RTTVAR_us_ = rtt_us / 2;
+    return;
+  }
+  const uint64_t srtt_us = SRTT_us_.value();
+  const uint64_t deviation_us = srtt_us > rtt_us ? srtt_us - rtt_us : rtt_us - srtt_us;
+  RTTVAR_us_ = (3 * RTTVAR_us_ + deviation_us) / 4;
+  SRTT_us_ = (7 * srtt_us + rtt_us) / 8;
+}
+
+uint64_t TCPSender::base_RTO_ms() const {
+  if (not rtt_estimation_) {
+    return initial_RTO_ms_;
+  }
+  if (not SRTT_us_.has_value()) {
+    return clamp(initial_RTO_ms_, RTO_min_ms_, RTO_max_ms_);
+  }
+  const uint64_t rto_us = SRTT_us_.value() + max<uint64_t>(1000, 4 * RTTVAR_us_);
+  return clamp((rto_us + 999) / 1000, RTO_min_ms_, RTO_max_ms_);
+}
+
+uint64_t TCPSender::send_window() const {
+  // A zero window still gets one sequence number at a time, to probe for it reopening.
+  return min(max<uint64_t>(window_size_, 1), congestion_window());
+}
+
+// The configured rate, else the congestion controller's, else twice the window per SRTT (Linux's
+// default for slow start, which lets the window keep growing while smoothing its bursts)
+optional<uint64_t> TCPSender::pacing_rate() const {
+  if (not pacing_) {
+    return {};
+  }
+  if (configured_pacing_rate_ > 0) {
+    return configured_pacing_rate_;
+  }
+  if (congestion_control_ and congestion_control_->pacing_rate().has_value()) {
+    return congestion_control_->pacing_rate();
+  }
+  if (not SRTT_us_.has_value() or SRTT_us_.value() == 0) {
+    return {};
+  }
+  return 2 * send_window() * 1'000'000 / SRTT_us_.value();
+}
+
+// While pacing holds segments back, the schedule carries on from where it was, so a tick()
+// releases every segment that fell due during it. Otherwise it starts afresh from now.
+uint64_t TCPSender::pacing_base_us() const {
+  return pacing_limited_ ? next_send_us_ : max(next_send_us_, now_ms_ * 1000);
+}
+
+// With large send, everything after the SYN goes out in super-segments, though when pacing, no
+// more than a millisecond's worth at a time (as Linux sizes its TSO bursts), to keep the bursts
+// short.
+uint64_t TCPSender::max_payload_size(optional<uint64_t> pacing_rate) const {
+  if (not large_send_ or not syn_sent_) {
+    return mss_;
+  }
+  const uint64_t super_segment_size = max<uint64_t>(TCPConfig::MAX_SUPER_SEGMENT_SIZE, mss_);
+  if (not pacing_rate.has_value()) {
+    return super_segment_size;
+  }
+  const uint64_t per_ms = pacing_rate.value() / 1000;
+  return clamp(per_ms - per_ms % mss_, mss_, super_segment_size);
+}
+
+void TCPSender::set_mss(uint64_t max_mss) {
+  search_high_ = max_mss;
+  change_mss(pmtu_probing_ ? min(mss_, max_mss) : max_mss);
+}
+
+void TCPSender::change_mss(uint64_t mss) {
+  if (congestion_control_ and mss != mss_) {
+    congestion_control_->set_mss(mss);
+  }
+  mss_ = mss;
+}
+
+uint64_t TCPSender::segment_size(const TCPSenderMessage &message) const {
+  if (probe_seqno_.has_value() and message.seqno == Wrap32::wrap(probe_seqno_.value(), isn_)) {
+    return max<uint64_t>(message.payload.size(), mss_);
+  }
+  return mss_;
+}
+
+// Halfway between the MSS known to get through and the search's upper bound, until they meet.
+// Not during fast recovery, when the window is for repairing losses.
+uint64_t TCPSender::next_probe_size() const {
+  if (not pmtu_probing_ or probe_seqno_.has_value() or in_recovery_ or
+      search_high_ < mss_ + PROBE_GRANULARITY) {
+    return 0;
+  }
+  return (mss_ + search_high_ + 1) / 2;
+}
+
+bool TCPSender::is_probe(const Outstanding &segment) const {
+  return probe_seqno_.has_value() and segment.seqno == probe_seqno_.value();
+}
+
+// RFC 4821 allows for a probe lost to congestion, not its size: only a few losses in a row at one
+// size lower the search's upper bound below it.
+void TCPSender::note_probe_lost() {
+  probe_seqno_.reset();
+  if (++probe_losses_ >= MAX_PROBES) {
+    search_high_ = probe_size_ - 1;
+    probe_losses_ = 0;
+  }
 }
 
 optional<TCPSenderMessage> TCPSender::maybe_send() {
-  // Your code here.
-  return {};
+  if (ready_.empty()) {
+    return {};
+  }
+  TCPSenderMessage message = move(ready_.front());
+  ready_.pop_front();
+  return message;
 }
 
 void TCPSender::push(Reader &outbound_stream) {
-  // Your code here.
-  (void)outbound_stream;
+  const uint64_t window = send_window();
+  const optional<uint64_t> rate = pacing_rate();
+
+  bool paced_out = false;
+  while (sequence_numbers_in_flight() < window and not fin_sent_) {
+    if (rate.has_value() and pacing_base_us() > now_ms_ * 1000) {
+      paced_out = not syn_sent_ or outbound_stream.bytes_buffered() > 0 or
+                  outbound_stream.is_finished();
+      break;
+    }
+
+    const uint64_t available = window - sequence_numbers_in_flight();
+
+    // A probe is a full segment of its size, so it needs that much data and room in the window.
+    const uint64_t probe = next_probe_size();
+    const bool probing = probe > 0 and syn_sent_ and outbound_stream.bytes_buffered() >= probe and
+                         available >= probe;
+
+    TCPSenderMessage message{Wrap32::wrap(next_seqno_, isn_), not syn_sent_, {}, false};
+    string payload;
+    read(outbound_stream,
+         probing ? probe
+                 : min<uint64_t>(max_payload_size(rate), available - message.sequence_length()),
+         payload);
+    message.payload = move(payload);
+    message.FIN = outbound_stream.is_finished() and available > message.sequence_length();
+
+    if (message.sequence_length() == 0) {
+      break;
+    }
+
+    syn_sent_ = true;
+    fin_sent_ = message.FIN;
+    if (probing) {
+      probe_seqno_ = next_seqno_;
+      probe_size_ = probe;
+    }
+    note_sent(outstanding_.emplace_back(next_seqno_, message.SYN, message.payload, 0,
+                                        message.payload.size(), message.FIN, now_ms_, false,
+                                        delivery_));
+    next_send_us_ = rate.has_value()
+                        ? pacing_base_us() + message.sequence_length() * 1'000'000 / rate.value()
+                        : now_ms_ * 1000;
+    next_seqno_ += message.sequence_length();
+    ready_.emplace_back(move(message));
+    timer_running_ = true;
+  }
+  pacing_limited_ = paced_out;
+
+  // With room left in the window and nothing to send, the application is what limits the rate,
+  // until everything now in flight has been delivered.
+  if (outbound_stream.bytes_buffered() == 0 and sequence_numbers_in_flight() < window) {
+    app_limited_until_ = max<uint64_t>(delivery_.delivered + sequence_numbers_in_flight(), 1);
+  }
+}
+
+void TCPSender::note_sent(Outstanding &segment) {
+  if (sequence_numbers_in_flight() == 0) {
+    delivery_.first_sent_ms = delivery_.delivered_time_ms = now_ms_;
+  }
+  delivery_.app_limited = app_limited_until_ != 0;
+  segment.sent_at_ms = now_ms_;
+  segment.delivery_at_send = delivery_;
+}
+
+optional<RateSample> TCPSender::note_delivered(const Outstanding &segment,
+                                               optional<RateSample> sample) {
+  delivery_.delivered += segment.sequence_length();
+  delivery_.delivered_time_ms = now_ms_;
+
+  // Measure from the most recently sent of the segments this ACK covers.
+  const DeliveryState &then = segment.delivery_at_send;
+  if (sample.has_value() and then.delivered < sample->prior_delivered) {
+    return sample;
+  }
+  delivery_.first_sent_ms = segment.sent_at_ms;
+  const uint64_t send_elapsed = segment.sent_at_ms - then.first_sent_ms;
+  const uint64_t ack_elapsed = delivery_.delivered_time_ms - then.delivered_time_ms;
+  return RateSample{delivery_.delivered - then.delivered, max(send_elapsed, ack_elapsed),
+                    then.delivered, then.app_limited};
 }
 
 TCPSenderMessage TCPSender::send_empty_message() const {
-  // Your code here.
-  return {};
+  return {Wrap32::wrap(next_seqno_, isn_), false, {}, false};
 }
 
-void TCPSender::receive(const TCPReceiverMessage &msg) {
-  // Your code here.
-  (void)msg;
+void TCPSender::receive(const TCPReceiverMessage &msg, bool carries_data) {
+  if (not msg.ackno.has_value()) {
+    window_size_ = msg.window_size;
+    return;
+  }
+  const uint64_t ackno = msg.ackno->unwrap(isn_, next_seqno_);
+  if (ackno > next_seqno_) {
+    return;  // acknowledges something that hasn't been sent
+  }
+  const bool same_window = msg.window_size == window_size_;
+  window_size_ = msg.window_size;
+  if (ackno < acked_seqno_) {
+    return;
+  }
+  note_sacks(msg.sacks());
+  if (ackno == acked_seqno_) {
+    // RFC 5681's duplicate ACK: a pure ACK, nothing new acknowledged, the window unchanged, and
+    // data outstanding. (An ACK of a zero-window probe is no sign of loss.)
+    if (fast_retransmit_ and not carries_data and same_window and window_size_ > 0 and
+        not outstanding_.empty()) {
+      note_duplicate_ack();
+    }
+    return;
+  }
+
+  // Forget the segments this fully acknowledges. The newest of them gives an RTT sample, unless
+  // it was retransmitted, since then the ACK may be for either transmission (Karn's algorithm).
+  optional<uint64_t> rtt_ms;
+  optional<RateSample> rate_sample;
+  while (not outstanding_.empty() and outstanding_.front().end() <= ackno) {
+    const Outstanding &acked = outstanding_.front();
+    rtt_ms = acked.retransmitted ? nullopt : optional{now_ms_ - acked.sent_at_ms};
+    rate_sample = note_delivered(acked, rate_sample);
+    outstanding_.pop_front();
+  }
+  if (app_limited_until_ != 0 and delivery_.delivered > app_limited_until_) {
+    app_limited_until_ = 0;
+  }
+
+  if (rtt_ms.has_value()) {
+    note_rtt(rtt_ms.value());
+  }
+
+  // The probe got through, so the path carries segments of its size.
+  if (probe_seqno_.has_value() and ackno >= probe_seqno_.value() + probe_size_) {
+    change_mss(probe_size_);
+    probe_seqno_.reset();
+    probe_losses_ = 0;
+  }
+
+  const uint64_t newly_acked = ackno - acked_seqno_;
+  acked_seqno_ = ackno;
+  duplicate_acks_ = 0;
+  while (not sacked_.empty() and sacked_.begin()->second <= ackno) {
+    sacked_.erase(sacked_.begin());
+  }
+  if (not sacked_.empty() and sacked_.begin()->first < ackno) {
+    sacked_[ackno] = sacked_.begin()->second;
+    sacked_.erase(sacked_.begin());
+  }
+  // Sub-millisecond intervals can't be measured with tick()'s clock, so they give no sample.
+  if (congestion_control_ and rate_sample.has_value() and rate_sample->interval_ms > 0) {
+    congestion_control_->on_rate_sample(rate_sample.value());
+  }
+
+  if (in_recovery_) {
+    if (congestion_control_) {
+      congestion_control_->on_recovery_ack(newly_acked, sequence_numbers_in_flight(), now_ms_,
+                                           rtt_ms);
+    }
+    // RFC 6582: an ACK short of `recover_` means the next segment was lost as well, unless it
+    // has been retransmitted already to fill a SACK hole.
+    const bool partial = ackno < recover_;
+    if (partial and (not congestion_control_ or congestion_control_->on_partial_ack(newly_acked))) {
+      Outstanding *hole =
+          outstanding_.front().seqno >= high_rxt_ ? &outstanding_.front() : next_hole();
+      if (hole != nullptr) {
+        retransmit(*hole);
+      }
+    } else {
+      in_recovery_ = false;
+      if (congestion_control_) {
+        congestion_control_->on_exit_recovery();
+      }
+    }
+  } else if (congestion_control_) {
+    congestion_control_->on_ack(newly_acked, sequence_numbers_in_flight(), now_ms_, rtt_ms);
+  }
+
+  RTO_ms_ = base_RTO_ms();
+  consecutive_retransmissions_ = 0;
+  timer_running_ = not outstanding_.empty();
+  timer_elapsed_ms_ = 0;
 }
 
 void TCPSender::tick(const size_t ms_since_last_tick) {
-  // Your code here.
-  (void)ms_since_last_tick;
+  now_ms_ += ms_since_last_tick;
+  if (not timer_running_) {
+    return;
+  }
+
+  timer_elapsed_ms_ += ms_since_last_tick;
+  if (timer_elapsed_ms_ < RTO_ms_ or outstanding_.empty()) {
+    return;
+  }
+
+  // A lost probe only means the path's MTU is smaller than that: resend its data by the MSS,
+  // without backing off the timer or telling the congestion controller.
+  if (is_probe(outstanding_.front())) {
+    const Outstanding &probe = outstanding_.front();
+    resend_oversized(probe.end());
+    timer_elapsed_ms_ = 0;
+    return;
+  }
+
+  // RFC 4821's black-hole detection: if segments of the MSS that probing found stop getting
+  // through (the path changed), fall back to the base MSS and search again below it. Nothing
+  // bigger will get through now, so resend all of that.
+  bool resent_front = false;
+  if (pmtu_probing_ and window_size_ > 0 and mss_ > TCPConfig::MAX_PAYLOAD_SIZE and
+      consecutive_retransmissions_ + 1 >= BLACK_HOLE_TIMEOUTS) {
+    search_high_ = mss_ - 1;
+    change_mss(TCPConfig::MAX_PAYLOAD_SIZE);
+    probe_losses_ = 0;
+    resent_front = outstanding_.front().length > mss_;
+    resend_oversized(next_seqno_);
+  }
+  if (not resent_front) {
+    retransmit(outstanding_.front());
+  }
+
+  // A timeout with a zero window is just an unanswered probe, not a sign of congestion.
+  if (window_size_ > 0) {
+    // Everything outstanding is suspect now, so its duplicate ACKs shouldn't set off fast
+    // retransmit again.
+    in_recovery_ = false;
+    duplicate_acks_ = 0;
+    recover_ = next_seqno_;
+    consecutive_retransmissions_++;
+    RTO_ms_ = rtt_estimation_ ? min(RTO_ms_ * 2, RTO_max_ms_) : RTO_ms_ * 2;
+    if (congestion_control_) {
+      congestion_control_->on_timeout(sequence_numbers_in_flight(), now_ms_);
+    }
+  }
+  timer_elapsed_ms_ = 0;
+}
+
+optional<uint64_t> TCPSender::next_timeout_ms() const {
+  optional<uint64_t> timeout;
+  if (timer_running_ and not outstanding_.empty()) {
+    timeout = RTO_ms_ - min(timer_elapsed_ms_, RTO_ms_);
+  }
+  if (pacing_limited_) {
+    const uint64_t due_ms = (next_send_us_ + 999) / 1000;
+    timeout = min(timeout.value_or(UINT64_MAX), due_ms - min(due_ms, now_ms_));
+  }
+  return timeout;
+}
+
+// Retransmissions don't wait for the pacing schedule: they are late already.
+void TCPSender::retransmit(Outstanding &segment) {
+  if (is_probe(segment)) {
+    note_probe_lost();
+  }
+  optional<Outstanding> rest = split(segment);
+  ready_.emplace_back(to_message(segment));
+  segment.retransmitted = true;
+  note_sent(segment);
+  high_rxt_ = max(high_rxt_, segment.end());
+
+  // (Inserting into the ring invalidates `segment`, so this comes last.)
+  if (rest.has_value()) {
+    outstanding_.insert(first_ending_after(rest->seqno), move(rest.value()));
+  }
+}
+
+// The segment's Buffer goes out as it is if it holds just the payload. Otherwise (once split) the
+// payload is copied into a Buffer of its own, which the segment keeps for any later resends.
+TCPSenderMessage TCPSender::to_message(Outstanding &segment) const {
+  if (segment.offset > 0 or segment.length < segment.data.size()) {
+    segment.data = string{string_view{segment.data}.substr(segment.offset, segment.length)};
+    segment.offset = 0;
+  }
+  return {Wrap32::wrap(segment.seqno, isn_), segment.SYN, segment.data, segment.FIN};
+}
+
+// Outstanding segments are in order and don't overlap, so this is a binary search.
+size_t TCPSender::first_ending_after(uint64_t seqno, size_t from) const {
+  size_t to = outstanding_.size();
+  while (from < to) {
+    const size_t mid = from + (to - from) / 2;
+    if (outstanding_[mid].end() <= seqno) {
+      from = mid + 1;
+    } else {
+      to = mid;
+    }
+  }
+  return from;
+}
+
+// Resend each outstanding segment before `end` that is bigger than the MSS, all of it, in the
+// pieces retransmit() splits it into
+void TCPSender::resend_oversized(uint64_t end) {
+  uint64_t oversized_end = 0;
+  for (size_t i = 0; i < outstanding_.size() and outstanding_[i].seqno < end; i++) {
+    const Outstanding &segment = outstanding_[i];
+    if (segment.length > mss_) {
+      oversized_end = segment.end();
+    }
+    if (segment.seqno < oversized_end) {
+      retransmit(outstanding_[i]);
+    }
+  }
+}
+
+// A lost segment bigger than the MSS (a super-segment, a probe, or one sent before the MSS came
+// down) is resent one MSS at a time, like any other loss: drop what has been acknowledged from
+// its front, and split off all but one MSS of what remains (a SYN is never part of one). Returns
+// the rest, still outstanding from the original transmission. Both are slices of the same Buffer.
+optional<TCPSender::Outstanding> TCPSender::split(Outstanding &segment) {
+  if (segment.length <= mss_) {
+    return {};
+  }
+  const uint64_t head = acked_seqno_ > segment.seqno ? acked_seqno_ - segment.seqno : 0;
+  segment.seqno += head;
+  segment.offset += head;
+  segment.length -= head;
+
+  optional<Outstanding> rest;
+  if (segment.length > mss_) {
+    rest = segment;
+    rest->seqno += mss_;
+    rest->offset += mss_;
+    rest->length -= mss_;
+    segment.length = mss_;
+    segment.FIN = false;
+  }
+  return rest;
+}
+
+void TCPSender::note_sacks(span<const TCPReceiverMessage::SACKBlock> blocks) {
+  for (const auto &block : blocks) {
+    uint64_t begin = max(block.left.unwrap(isn_, next_seqno_), acked_seqno_);
+    uint64_t end = min(block.right.unwrap(isn_, next_seqno_), next_seqno_);
+    if (begin >= end) {
+      continue;  // Already acknowledged, or for data never sent
+    }
+
+    // Merge with any ranges it overlaps or touches.
+    auto it = sacked_.upper_bound(begin);
+    if (it != sacked_.begin() and prev(it)->second >= begin) {
+      --it;
+    }
+    while (it != sacked_.end() and it->first <= end) {
+      begin = min(begin, it->first);
+      end = max(end, it->second);
+      it = sacked_.erase(it);
+    }
+    sacked_.emplace(begin, end);
+  }
+}
+
+bool TCPSender::is_sacked(const Outstanding &segment) const {
+  auto it = sacked_.upper_bound(segment.seqno);
+  return it != sacked_.begin() and
+         prev(it)->second >= segment.end();
+}
+
+// RFC 6675's NextSeg(), simplified: the first segment past what this recovery has already
+// retransmitted that isn't SACKed, provided something above it is (so it was probably lost,
+// rather than still on its way). Both searches are binary, so long SACKed runs are skipped over.
+TCPSender::Outstanding *TCPSender::next_hole() {
+  if (sacked_.empty()) {
+    return nullptr;
+  }
+  const uint64_t high_sacked = sacked_.rbegin()->second;
+  size_t i = first_ending_after(high_rxt_);
+  while (i < outstanding_.size() and outstanding_[i].seqno < high_sacked) {
+    if (not is_sacked(outstanding_[i])) {
+      return &outstanding_[i];
+    }
+    i = first_ending_after(prev(sacked_.upper_bound(outstanding_[i].seqno))->second, i);
+  }
+  return nullptr;
+}
+
+// Three duplicate ACKs mean the segment after the acknowledged data was probably lost, while
+// later ones are getting through: retransmit it without waiting for the timer (RFC 5681).
+void TCPSender::note_duplicate_ack() {
+  duplicate_acks_++;
+  if (in_recovery_) {
+    if (congestion_control_) {
+      congestion_control_->on_recovery_dup_ack();
+    }
+    // Each duplicate ACK means a segment has left the network, making room to fill a hole.
+    if (Outstanding *hole = next_hole()) {
+      retransmit(*hole);
+    }
+    return;
+  }
+
+  // A lost probe is no sign of congestion: just resend its data.
+  if (duplicate_acks_ == FAST_RETRANSMIT_THRESHOLD and is_probe(outstanding_.front())) {
+    const Outstanding &probe = outstanding_.front();
+    resend_oversized(probe.end());
+    return;
+  }
+
+  // Once per window of data: not again for losses among what was in flight at the last one.
+  if (duplicate_acks_ == FAST_RETRANSMIT_THRESHOLD and acked_seqno_ >= recover_) {
+    in_recovery_ = true;
+    recover_ = next_seqno_;
+    high_rxt_ = acked_seqno_;
+    retransmit(outstanding_.front());
+    if (congestion_control_) {
+      congestion_control_->on_enter_recovery(sequence_numbers_in_flight(), now_ms_);
+    }
+  }
 }
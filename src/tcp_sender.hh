@@ -1,35 +1,183 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "ring_buffer.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+
 class TCPSender {
   Wrap32 isn_;
   uint64_t initial_RTO_ms_;
+  uint64_t RTO_ms_{initial_RTO_ms_};
+
+  // RFC 6298 round-trip estimation. SRTT is always kept, but the RTO only follows it if enabled
+  // (otherwise it resets to initial_RTO_ms_).
+  bool rtt_estimation_{};
+  uint64_t RTO_min_ms_{};
+  uint64_t RTO_max_ms_{UINT64_MAX};
+  std::optional<uint64_t> SRTT_us_{};  // smoothed RTT, in microseconds to keep the fractions
+  uint64_t RTTVAR_us_{};               // RTT variation, likewise
+
+  // Limits what may be in flight, alongside the receiver's window (nullptr for no limit)
+  std::unique_ptr<CongestionControl> congestion_control_{};
+
+  // Delivery-rate estimation (draft-cheng-iccrg-delivery-rate-estimation): the connection's
+  // delivery progress, snapshotted into each segment when it is sent, so that its ACK can tell
+  // how much was delivered over how long
+  struct DeliveryState {
+    uint64_t delivered;          // sequence numbers acknowledged so far
+    uint64_t delivered_time_ms;  // when `delivered` last grew
+    uint64_t first_sent_ms;      // when the segment most recently acknowledged was sent
+    bool app_limited;            // whether the sender had run out of data
+  };
+  DeliveryState delivery_{};
+  uint64_t app_limited_until_{};  // delivery_.delivered at which the app-limited period ends
+
+  // A segment that has been sent but not fully acknowledged. Its payload is a slice of the Buffer
+  // it was first sent in, shared with that message, so neither retransmitting the segment nor
+  // splitting it by the MSS copies the bytes it keeps.
+  struct Outstanding {
+    uint64_t seqno;  // absolute sequence number of the segment's first sequence number
+    bool SYN;
+    Buffer data;  // holds the payload, at [offset, offset + length)
+    uint64_t offset;
+    uint64_t length;
+    bool FIN;
+    uint64_t sent_at_ms;
+    bool retransmitted;
+    DeliveryState delivery_at_send;
+
+    uint64_t sequence_length() const { return SYN + length + FIN; }
+    uint64_t end() const { return seqno + sequence_length(); }
+  };
+  // Pacing: each new segment waits for its turn in a schedule kept in microseconds, so that
+  // rates finer than one segment per tick() come out right on average
+  bool pacing_{};
+  uint64_t configured_pacing_rate_{};
+  uint64_t next_send_us_{};  // when the next segment is due
+  bool pacing_limited_{};    // whether the last push() had to wait for the schedule
+
+  // Large send: one message may carry up to TCPConfig::MAX_SUPER_SEGMENT_SIZE bytes, for the
+  // adapter to split by MSS, so the bookkeeping here is per super-segment rather than per MSS
+  bool large_send_{};
+
+  // The MSS in use: TCPConfig::MAX_PAYLOAD_SIZE, until set_mss() gives the negotiated one
+  uint64_t mss_{TCPConfig::MAX_PAYLOAD_SIZE};
+
+  // Packetization-layer path MTU discovery (RFC 4821): starting from the base MSS, a binary
+  // search for the largest that gets through, by now and then sending one segment (the probe)
+  // bigger than the current MSS. A lost probe says nothing about congestion.
+  static constexpr uint64_t PROBE_GRANULARITY = 32;   // Stop once the bounds are this close
+  static constexpr unsigned MAX_PROBES = 3;           // Losses at one size before ruling it out
+  static constexpr uint64_t BLACK_HOLE_TIMEOUTS = 2;  // Timeouts in a row that reset the MSS
+  bool pmtu_probing_{};
+  uint64_t search_high_{TCPConfig::MAX_PAYLOAD_SIZE};  // The largest MSS that might get through
+  std::optional<uint64_t> probe_seqno_{};              // The probe in flight, if any
+  uint64_t probe_size_{};
+  unsigned probe_losses_{};  // At probe_size_
+
+  // Both queues are rings, so once they have grown to the most ever in flight, sending and
+  // acknowledging segments allocates nothing for them.
+  RingBuffer<Outstanding> outstanding_{};  // oldest first
+  RingBuffer<TCPSenderMessage> ready_{};   // segments waiting for maybe_send()
+
+  uint64_t next_seqno_{};   // absolute sequence number of the next byte to send
+  uint64_t acked_seqno_{};  // absolute sequence number the receiver has acknowledged up to
+  uint64_t window_size_{1};
+  bool syn_sent_{};
+  bool fin_sent_{};
+
+  uint64_t now_ms_{};  // total time passed, according to tick()
+  bool timer_running_{};
+  uint64_t timer_elapsed_ms_{};
+  uint64_t consecutive_retransmissions_{};
+
+  // Fast retransmit and fast recovery (RFC 5681, with RFC 6582's `recover`)
+  static constexpr uint64_t FAST_RETRANSMIT_THRESHOLD = 3;
+  bool fast_retransmit_{};
+  uint64_t duplicate_acks_{};
+  bool in_recovery_{};
+  uint64_t recover_{};  // next_seqno_ when recovery last began (or the timer last expired)
+
+  // SACK scoreboard (RFC 6675): the ranges above acked_seqno_ the receiver has selectively
+  // acknowledged, disjoint and keyed by their start. Whether a segment has been SACKed is one
+  // lookup, however many segments are in flight.
+  std::map<uint64_t, uint64_t> sacked_{};
+  uint64_t high_rxt_{};  // End of the highest segment retransmitted in this recovery
+
+  void note_rtt(uint64_t rtt_ms);         // Update SRTT and RTTVAR from an RTT sample
+  uint64_t base_RTO_ms() const;           // The RTO before any backoff
+  uint64_t send_window() const;           // What may be in flight, by both windows
+  uint64_t pacing_base_us() const;        // When the schedule resumes from
+  uint64_t max_payload_size(std::optional<uint64_t> pacing_rate) const;
+  void change_mss(uint64_t mss);  // Use a new MSS, and tell the congestion controller
+  uint64_t next_probe_size() const;  // The size of probe to send next (0 for none)
+  bool is_probe(const Outstanding &segment) const;
+  void note_probe_lost();
+  void retransmit(Outstanding &segment);  // Queue an outstanding segment again
+  TCPSenderMessage to_message(Outstanding &segment) const;  // The message that (re)sends it
+  size_t first_ending_after(uint64_t seqno, size_t from = 0) const;  // Index in outstanding_
+  std::optional<Outstanding> split(Outstanding &segment);  // To resend an MSS from its head
+  void resend_oversized(uint64_t end);
+  void note_duplicate_ack();              // The third in a row triggers fast retransmit
+  void note_sent(Outstanding &segment);   // Record a (re)transmission's time and delivery state
+  void note_sacks(std::span<const TCPReceiverMessage::SACKBlock> blocks);
+  bool is_sacked(const Outstanding &segment) const;
+  Outstanding *next_hole();  // The next lost segment to retransmit during recovery, if any
+  std::optional<RateSample> note_delivered(const Outstanding &segment,
+                                           std::optional<RateSample> sample);
 
  public:
   /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
   TCPSender(uint64_t initial_RTO_ms, std::optional<Wrap32> fixed_isn);
 
+  /* Construct TCP sender from a TCPConfig (RTO, ISN and congestion control) */
+  explicit TCPSender(const TCPConfig &config);
+
   /* Push bytes from the outbound stream */
   void push(Reader &outbound_stream);
 
   /* Send a TCPSenderMessage if needed (or empty optional otherwise) */
   std::optional<TCPSenderMessage> maybe_send();
 
+  /* Set the largest MSS the connection may use (the smaller of the two announced in the SYNs):
+   * the MSS itself, or with PMTU probing, the limit of the search. */
+  void set_mss(uint64_t max_mss);
+
+  /* The payload per segment that `message` should be split into, should it be a super-segment
+   * (a probe goes whole) */
+  uint64_t segment_size(const TCPSenderMessage &message) const;
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage send_empty_message() const;
 
-  /* Receive an act on a TCPReceiverMessage from the peer's receiver */
-  void receive(const TCPReceiverMessage &msg);
+  /* Receive an act on a TCPReceiverMessage from the peer's receiver. `carries_data` says the
+   * segment it came in also carried data (or a SYN or FIN), which makes it no duplicate ACK. */
+  void receive(const TCPReceiverMessage &msg, bool carries_data = false);
 
   /* Time has passed by the given # of milliseconds since the last time the tick() method was
    * called. */
   void tick(uint64_t ms_since_last_tick);
 
+  /* How many milliseconds until a tick() would have something to do: the retransmission timer
+   * expiring, or the pacing schedule letting a segment go (empty if neither is pending) */
+  std::optional<uint64_t> next_timeout_ms() const;
+
   /* Accessors for use in testing */
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions()
       const;  // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;  // The congestion window (UINT64_MAX if there is none)
+  std::optional<uint64_t> smoothed_RTT_ms() const;  // SRTT (empty until there is an RTT sample)
+  uint64_t RTO_ms() const;  // The current retransmission timeout, including any backoff
+  std::optional<uint64_t> pacing_rate() const;  // Bytes/second, if pacing (and a rate is known)
+  uint64_t mss() const { return mss_; }
+  const CongestionControl *congestion_control() const { return congestion_control_.get(); }
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
@@ -13,10 +14,12 @@ class Wrap32 {
   uint32_t raw_value_{};
 
  public:
-  explicit Wrap32(uint32_t raw_value) : raw_value_(raw_value) {}
+  constexpr explicit Wrap32(uint32_t raw_value) : raw_value_(raw_value) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap(uint64_t n, Wrap32 zero_point);
+  static constexpr Wrap32 wrap(uint64_t n, Wrap32 zero_point) {
+    return zero_point + static_cast<uint32_t>(n);
+  }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero
@@ -25,8 +28,23 @@ class Wrap32 {
    * There are many possible absolute sequence numbers that all wrap to the same Wrap32.
    * The unwrap method should return the one that is closest to the checkpoint.
    */
-  uint64_t unwrap(Wrap32 zero_point, uint64_t checkpoint) const;
+  constexpr uint64_t unwrap(Wrap32 zero_point, uint64_t checkpoint) const {
+    // The signed 32-bit distance from the checkpoint picks the closest candidate, except that a
+    // candidate below zero (its top bit set, as absolute sequence numbers never reach 2^63) must
+    // come from the next 2^32 block instead. No branches, so unwrap_many() can vectorize this.
+    const auto delta = static_cast<int32_t>(raw_value_ - zero_point.raw_value_ -
+                                            static_cast<uint32_t>(checkpoint));
+    const uint64_t candidate = checkpoint + static_cast<uint64_t>(static_cast<int64_t>(delta));
+    return candidate + ((candidate >> 63) << 32);
+  }
 
-  Wrap32 operator+(uint32_t n) const { return Wrap32{raw_value_ + n}; }
-  bool operator==(const Wrap32 &other) const { return raw_value_ == other.raw_value_; }
+  /*
+   * Unwrap every element of `in` into the same position of `out` (which must be at least as
+   * long), as unwrap() would, for bulk work such as a segment's SACK blocks or a batch of ACKs.
+   */
+  static void unwrap_many(std::span<const Wrap32> in, Wrap32 zero_point, uint64_t checkpoint,
+                          std::span<uint64_t> out);
+
+  constexpr Wrap32 operator+(uint32_t n) const { return Wrap32{raw_value_ + n}; }
+  constexpr bool operator==(const Wrap32 &other) const { return raw_value_ == other.raw_value_; }
 };
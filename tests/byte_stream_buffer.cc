@@ -0,0 +1,63 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    for (const auto storage : {ByteStream::Storage::Queue, ByteStream::Storage::Ring}) {
+      {
+        ByteStreamTestHarness test{"push Buffer slices", 8, storage};
+
+        test.execute(PushBuffer{"xxcatxx", 2, 3});
+        test.execute(BytesPushed{3});
+        test.execute(PushBuffer{"dog", 1, 100});
+        test.execute(BytesPushed{5});
+        test.execute(PushBuffer{"hello", 5, 3});
+        test.execute(BytesPushed{5});
+        test.execute(Peek{"catog"});
+        test.execute(PushBuffer{"abcdefgh", 0, 8});
+        test.execute(BytesPushed{8});
+        test.execute(AvailableCapacity{0});
+        test.execute(ReadAll{"catogabc"});
+      }
+
+      {
+        ByteStreamTestHarness test{"pop across Buffer slices", 15, storage};
+
+        test.execute(PushBuffer{"0123456789", 0, 4});
+        test.execute(PushBuffer{"0123456789", 4, 6});
+        test.execute(Pop{3});
+        test.execute(BytesBuffered{7});
+        test.execute(Pop{2});
+        test.execute(Peek{"56789"});
+        test.execute(Close{});
+        test.execute(ReadAll{"56789"});
+        test.execute(IsFinished{true});
+      }
+    }
+
+    {
+      // With Queue storage, the pushed chunk is referenced rather than copied.
+      ByteStream bs{16};
+      const Buffer chunk{"zero-copy"};
+      bs.writer().push(chunk, 5, 4);
+      if (bs.reader().peek().data() != string_view{chunk}.data() + 5) {
+        throw runtime_error("push(Buffer) copied the chunk instead of referencing it");
+      }
+      const ByteStream copy = bs;
+      bs.reader().pop(4);
+      if (copy.reader().peek() != "copy") {
+        throw runtime_error("a copied ByteStream lost its view of a shared chunk");
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    {
+      ByteStreamTestHarness test{"peek_all empty", 15};
+
+      test.execute(PeekAll{{}});
+      test.execute(Push{"hello"});
+      test.execute(PeekAll{{}, 0});
+    }
+
+    {
+      ByteStreamTestHarness test{"peek_all chunks", 15};
+
+      test.execute(Push{"cat"});
+      test.execute(Push{"tac"});
+      test.execute(Push{"dog"});
+      test.execute(PeekAll{{"cat", "tac", "dog"}});
+      test.execute(Pop{2});
+      test.execute(PeekAll{{"t", "tac", "dog"}});
+      test.execute(PeekAll{{"t", "ta"}, 3});
+      test.execute(Pop{4});
+      test.execute(PeekAll{{"dog"}});
+      test.execute(Pop{3});
+      test.execute(PeekAll{{}});
+    }
+
+    {
+      ByteStreamTestHarness test{"peek_all ring", 6, ByteStream::Storage::Ring};
+
+      test.execute(Push{"012345"});
+      test.execute(PeekAll{{"012345"}});
+      test.execute(Pop{5});
+      test.execute(Push{"6789a"});
+      test.execute(PeekAll{{"567", "89a"}});
+      test.execute(PeekAll{{"567", "8"}, 4});
+      test.execute(PeekAll{{"56"}, 2});
+      test.execute(Pop{3});
+      test.execute(PeekAll{{"89a"}});
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    for (const auto storage : {ByteStream::Storage::Queue, ByteStream::Storage::Ring}) {
+      {
+        ByteStreamTestHarness test{"read_into", 8, storage};
+
+        test.execute(ReadInto{4, ""});
+        test.execute(Push{"cat"});
+        test.execute(Push{"dog"});
+        test.execute(ReadInto{0, ""});
+        test.execute(ReadInto{4, "catd"});
+        test.execute(BytesPopped{4});
+        test.execute(Push{"fish"});
+        test.execute(ReadInto{100, "ogfish"});
+        test.execute(BytesPopped{10});
+        test.execute(BufferEmpty{true});
+      }
+
+      {
+        ByteStreamTestHarness test{"pop_all_into", 8, storage};
+
+        test.execute(PopAllInto{"", ""});
+        test.execute(Push{"abc"});
+        test.execute(Push{"defgh"});
+        test.execute(Pop{1});
+        test.execute(PopAllInto{"xy", "xybcdefgh"});
+        test.execute(Push{"ij"});
+        test.execute(Close{});
+        test.execute(PopAllInto{"", "ij"});
+        test.execute(IsFinished{true});
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    constexpr auto ring = ByteStream::Storage::Ring;
+
+    {
+      ByteStreamTestHarness test{"ring: capacity", 5, ring};
+
+      test.execute(Push{"abcdefg"});
+      test.execute(BytesPushed{5});
+      test.execute(AvailableCapacity{0});
+      test.execute(PeekOnce{"abcde"});
+      test.execute(Pop{2});
+      test.execute(AvailableCapacity{2});
+      test.execute(Push{"fgh"});
+      test.execute(BytesPushed{7});
+      test.execute(Peek{"cdefg"});
+      test.execute(ReadAll{"cdefg"});
+      test.execute(BytesPopped{7});
+    }
+
+    {
+      // A 6-byte capacity rounds up to an 8-byte ring, so this write wraps around its end.
+      ByteStreamTestHarness test{"ring: wraparound", 6, ring};
+
+      test.execute(Push{"012345"});
+      test.execute(Pop{5});
+      test.execute(Push{"6789a"});
+      test.execute(BytesBuffered{6});
+      test.execute(PeekOnce{"567"});
+      test.execute(Pop{3});
+      test.execute(PeekOnce{"89a"});
+      test.execute(Push{"bcd"});
+      test.execute(Peek{"89abcd"});
+      test.execute(Close{});
+      test.execute(IsFinished{false});
+      test.execute(ReadAll{"89abcd"});
+      test.execute(IsFinished{true});
+    }
+
+    {
+      ByteStreamTestHarness test{"ring: over-pop", 4, ring};
+
+      test.execute(Push{"ab"});
+      test.execute(Pop{10});
+      test.execute(BytesPopped{2});
+      test.execute(BufferEmpty{true});
+      test.execute(AvailableCapacity{4});
+      test.execute(Push{"wxyz"});
+      test.execute(ReadAll{"wxyz"});
+    }
+
+    {
+      ByteStreamTestHarness test{"ring: zero capacity", 0, ring};
+
+      test.execute(Push{"a"});
+      test.execute(BytesPushed{0});
+      test.execute(BufferEmpty{true});
+      test.execute(Close{});
+      test.execute(IsFinished{true});
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+int main() {
+  try {
+    for (const auto storage : {ByteStream::Storage::Queue, ByteStream::Storage::Ring}) {
+      {
+        ByteStreamTestHarness test{"grow while buffered", 4, storage};
+
+        test.execute(Push{"abc"});
+        test.execute(Pop{2});
+        test.execute(Push{"defgh"});
+        test.execute(BytesBuffered{4});
+        test.execute(AvailableCapacity{0});
+        test.execute(SetCapacity{12});
+        test.execute(AvailableCapacity{8});
+        test.execute(Peek{"cdef"});
+        test.execute(Push{"ijklmnopqrst"});
+        test.execute(BytesBuffered{12});
+        test.execute(ReadAll{"cdefijklmnop"});
+      }
+
+      {
+        ByteStreamTestHarness test{"shrink below buffered", 16, storage};
+
+        test.execute(Push{"0123456789"});
+        test.execute(Pop{3});
+        test.execute(SetCapacity{4});
+        test.execute(BytesBuffered{7});
+        test.execute(AvailableCapacity{0});
+        test.execute(Push{"x"});
+        test.execute(BytesPushed{10});
+        test.execute(Peek{"3456789"});
+        test.execute(Pop{5});
+        test.execute(AvailableCapacity{2});
+        test.execute(Push{"xyz"});
+        test.execute(ReadAll{"89xy"});
+      }
+
+      {
+        ByteStreamTestHarness test{"default watermarks follow capacity", 2, storage};
+        auto counts = make_shared<CallbackCounts>();
+
+        test.execute(InstallCallbacks{counts});
+        test.execute(SetCapacity{4});
+        test.execute(Push{"abcd"});
+        test.execute(Pop{1});
+        test.execute(CallbacksFired{counts, 1, 1});
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#include "exception.hh"
+#include "file_descriptor.hh"
+#include "spsc_byte_stream.hh"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+string make_data(const size_t input_len, const size_t random_seed) {
+  default_random_engine rd{random_seed};
+  uniform_int_distribution<char> ud;
+  string ret;
+  for (size_t i = 0; i < input_len; ++i) {
+    ret += ud(rd);
+  }
+  return ret;
+}
+
+// Hand `data` from a writer thread to this thread through an SPSCByteStream. With `use_poll`, this
+// thread waits in poll() on the stream's event, as a thread running an EventLoop would.
+string transfer_spsc(const string &data, const size_t capacity, const size_t write_size,
+                     const bool use_poll) {
+  SPSCByteStream stream{capacity};
+
+  thread writer{[&] {
+    string_view remaining = data;
+    while (not remaining.empty()) {
+      const uint64_t pushed = stream.push(remaining.substr(0, write_size));
+      if (pushed == 0) {
+        stream.wait_for_capacity();
+      }
+      remaining.remove_prefix(pushed);
+    }
+    stream.close();
+  }};
+
+  string output_data;
+  output_data.reserve(data.size());
+  while (not stream.is_finished()) {
+    if (not use_poll) {
+      stream.wait_for_data();
+    } else if (stream.arm_data_event()) {
+      pollfd pfd{stream.data_event().fd_num(), POLLIN, 0};
+      CheckSystemCall("poll", ::poll(&pfd, 1, -1));
+      stream.clear_data_event();
+      continue;
+    }
+    const auto peeked = stream.peek();
+    output_data += peeked;
+    stream.pop(peeked.size());
+  }
+
+  writer.join();
+  return output_data;
+}
+
+// Hand `data` from a writer thread to this thread through an AF_UNIX socketpair, as
+// TCPMinnowSocket does between the owner thread and the TCP thread
+string transfer_socketpair(const string &data, const size_t write_size) {
+  array<int, 2> fds{};
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()) != 0) {
+    throw runtime_error("socketpair failed");
+  }
+  FileDescriptor reader_fd{fds[0]};
+  FileDescriptor writer_fd{fds[1]};
+
+  thread writer{[&] {
+    string_view remaining = data;
+    while (not remaining.empty()) {
+      remaining.remove_prefix(writer_fd.write(remaining.substr(0, write_size)));
+    }
+    writer_fd.close();
+  }};
+
+  string output_data;
+  output_data.reserve(data.size());
+  string buffer;
+  while (not reader_fd.eof()) {
+    reader_fd.read(buffer);
+    output_data += buffer;
+  }
+
+  writer.join();
+  return output_data;
+}
+
+void speed_test(const size_t input_len,    // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t random_seed,  // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t write_size)   // NOLINT(bugprone-easily-swappable-parameters)
+{
+  const string data = make_data(input_len, random_seed);
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  for (const string name : {"SPSCByteStream", "SPSCByteStream+poll", "socketpair"}) {
+    const auto start_time = steady_clock::now();
+    const bool use_poll = name == "SPSCByteStream+poll";
+    const string output_data = name == "socketpair"
+                                   ? transfer_socketpair(data, write_size)
+                                   : transfer_spsc(data, capacity, write_size, use_poll);
+    const auto stop_time = steady_clock::now();
+
+    if (data != output_data) {
+      throw runtime_error("Mismatch between data written and read");
+    }
+
+    auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+    auto bytes_per_second = static_cast<double>(input_len) / test_duration.count();
+    auto bits_per_second = 8 * bytes_per_second;
+    auto gigabits_per_second = bits_per_second / 1e9;
+
+    cout << "Cross-thread " << name << " with capacity=" << capacity
+         << ", write_size=" << write_size << " reached " << fixed << setprecision(2)
+         << gigabits_per_second << " Gbit/s.\n";
+
+    debug_output << "      " << setw(19) << name << " cross-thread throughput: " << fixed
+                 << setprecision(2) << gigabits_per_second << " Gbit/s\n";
+
+    if (gigabits_per_second < 0.1) {
+      throw runtime_error("Cross-thread " + name + " did not meet minimum speed of 0.1 Gbit/s.");
+    }
+  }
+}
+
+void program_body() {
+  speed_test(1e8, 65536, 789, 1500);
+  speed_test(1e7, 65536, 789, 64);
+}
+
+}  // namespace
+
+int main() {
+  try {
+    program_body();
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
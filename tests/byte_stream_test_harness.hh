@@ -6,8 +6,10 @@
 #include <concepts>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 static_assert(sizeof(Reader) == sizeof(ByteStream),
               "Please add member variables to the ByteStream base, not the ByteStream Reader.");
@@ -17,9 +19,12 @@ static_assert(sizeof(Writer) == sizeof(ByteStream),
 
 class ByteStreamTestHarness : public TestHarness<ByteStream> {
  public:
-  ByteStreamTestHarness(std::string test_name, uint64_t capacity)
-      : TestHarness(move(test_name), "capacity=" + std::to_string(capacity), ByteStream{capacity}) {
-  }
+  ByteStreamTestHarness(std::string test_name, uint64_t capacity,
+                        ByteStream::Storage storage = ByteStream::Storage::Queue)
+      : TestHarness(move(test_name),
+                    "capacity=" + std::to_string(capacity) +
+                        (storage == ByteStream::Storage::Ring ? ", storage=ring" : ""),
+                    ByteStream{capacity, storage}) {}
 
   size_t peek_size() { return object().reader().peek().size(); }
 };
@@ -36,6 +41,29 @@ struct Push : public Action<ByteStream> {
   void execute(ByteStream &bs) const override { bs.writer().push(data_); }
 };
 
+struct PushBuffer : public Action<ByteStream> {
+  std::string data_;
+  uint64_t offset_, len_;
+
+  PushBuffer(std::string data, uint64_t offset, uint64_t len)
+      : data_(move(data)), offset_(offset), len_(len) {}
+  std::string description() const override {
+    return "push Buffer \"" + Printer::prettify(data_) + "\" [" + std::to_string(offset_) +
+           ", +" + std::to_string(len_) + "] to the stream";
+  }
+  void execute(ByteStream &bs) const override { bs.writer().push(Buffer{data_}, offset_, len_); }
+};
+
+struct SetCapacity : public Action<ByteStream> {
+  uint64_t capacity_;
+
+  explicit SetCapacity(uint64_t capacity) : capacity_(capacity) {}
+  std::string description() const override {
+    return "set_capacity( " + std::to_string(capacity_) + " )";
+  }
+  void execute(ByteStream &bs) const override { bs.writer().set_capacity(capacity_); }
+};
+
 struct Close : public Action<ByteStream> {
   std::string description() const override { return "close"; }
   void execute(ByteStream &bs) const override { bs.writer().close(); }
@@ -104,6 +132,32 @@ struct PeekOnce : public Peek {
   }
 };
 
+struct PeekAll : public Expectation<ByteStream> {
+  std::vector<std::string> output_;
+  uint64_t max_len_;
+
+  explicit PeekAll(std::vector<std::string> output, uint64_t max_len = UINT64_MAX)
+      : output_(move(output)), max_len_(max_len) {}
+
+  std::string description() const override {
+    std::string ret = "peek_all(" + (max_len_ == UINT64_MAX ? "" : std::to_string(max_len_)) +
+                      ") gives {";
+    for (const auto &view : output_) {
+      ret += " \"" + Printer::prettify(view) + "\"";
+    }
+    return ret + " }";
+  }
+
+  void execute(ByteStream &bs) const override {
+    std::vector<std::string_view> views{"stale"};
+    bs.reader().peek_all(views, max_len_);
+    if (not std::equal(views.begin(), views.end(), output_.begin(), output_.end())) {
+      throw ExpectationViolation{"Expected " + description().substr(description().find('{')) +
+                                 " but found " + std::to_string(views.size()) + " span(s)"};
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream> {
   using ExpectBool::ExpectBool;
   std::string name() const override { return "is_closed"; }
@@ -175,3 +229,94 @@ struct ReadAll : public Expectation<ByteStream> {
     empty_.execute(bs);
   }
 };
+
+struct ReadInto : public Expectation<ByteStream> {
+  uint64_t len_;
+  std::string output_;
+
+  ReadInto(uint64_t len, std::string output) : len_(len), output_(move(output)) {}
+
+  std::string description() const override {
+    return "read_into(" + std::to_string(len_) + " bytes) gives \"" + Printer::prettify(output_) +
+           "\"";
+  }
+
+  void execute(ByteStream &bs) const override {
+    std::string got(len_, '\0');
+    got.resize(bs.reader().read_into(got));
+    if (got != output_) {
+      throw ExpectationViolation{"Expected to read \"" + Printer::prettify(output_) +
+                                 "\", but found \"" + Printer::prettify(got) + "\""};
+    }
+  }
+};
+
+struct PopAllInto : public Expectation<ByteStream> {
+  std::string prefix_;
+  std::string output_;
+  BufferEmpty empty_{true};
+
+  PopAllInto(std::string prefix, std::string output)
+      : prefix_(move(prefix)), output_(move(output)) {}
+
+  std::string description() const override {
+    return "pop_all_into(\"" + Printer::prettify(prefix_) + "\") gives \"" +
+           Printer::prettify(output_) + "\"";
+  }
+
+  void execute(ByteStream &bs) const override {
+    std::string got = prefix_;
+    bs.reader().pop_all_into(got);
+    if (got != output_) {
+      throw ExpectationViolation{"Expected \"" + Printer::prettify(output_) +
+                                 "\", but found \"" + Printer::prettify(got) + "\""};
+    }
+    empty_.execute(bs);
+  }
+};
+
+struct SetWatermarks : public Action<ByteStream> {
+  uint64_t low_, high_;
+
+  SetWatermarks(uint64_t low, uint64_t high) : low_(low), high_(high) {}
+  std::string description() const override {
+    return "set_watermarks(" + std::to_string(low_) + ", " + std::to_string(high_) + ")";
+  }
+  void execute(ByteStream &bs) const override { bs.writer().set_watermarks(low_, high_); }
+};
+
+// Counts how many times the stream's readable and writable callbacks have fired
+struct CallbackCounts {
+  size_t readable{};
+  size_t writable{};
+};
+
+struct InstallCallbacks : public Action<ByteStream> {
+  std::shared_ptr<CallbackCounts> counts_;
+
+  explicit InstallCallbacks(std::shared_ptr<CallbackCounts> counts) : counts_(move(counts)) {}
+  std::string description() const override { return "install readable/writable callbacks"; }
+  void execute(ByteStream &bs) const override {
+    bs.reader().on_readable([counts = counts_] { ++counts->readable; });
+    bs.writer().on_writable([counts = counts_] { ++counts->writable; });
+  }
+};
+
+struct CallbacksFired : public Expectation<ByteStream> {
+  std::shared_ptr<CallbackCounts> counts_;
+  size_t readable_, writable_;
+
+  CallbacksFired(std::shared_ptr<CallbackCounts> counts, size_t readable, size_t writable)
+      : counts_(move(counts)), readable_(readable), writable_(writable) {}
+  std::string description() const override {
+    return "readable callback fired " + std::to_string(readable_) +
+           " time(s) and writable callback fired " + std::to_string(writable_) + " time(s)";
+  }
+  void execute(ByteStream & /* unused */) const override {
+    if (counts_->readable != readable_ or counts_->writable != writable_) {
+      throw ExpectationViolation{"Expected " + description() + ", but they fired " +
+                                 std::to_string(counts_->readable) + " and " +
+                                 std::to_string(counts_->writable) + " time(s)"};
+    }
+  }
+};
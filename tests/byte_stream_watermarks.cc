@@ -0,0 +1,82 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+int main() {
+  try {
+    for (const auto storage : {ByteStream::Storage::Queue, ByteStream::Storage::Ring}) {
+      {
+        ByteStreamTestHarness test{"readable edges", 10, storage};
+        auto counts = make_shared<CallbackCounts>();
+
+        test.execute(InstallCallbacks{counts});
+        test.execute(Push{""});
+        test.execute(CallbacksFired{counts, 0, 0});
+        test.execute(Push{"ab"});
+        test.execute(CallbacksFired{counts, 1, 0});
+        test.execute(Push{"cd"});
+        test.execute(CallbacksFired{counts, 1, 0});
+        test.execute(Pop{4});
+        test.execute(Push{"e"});
+        test.execute(CallbacksFired{counts, 2, 0});
+        test.execute(Close{});
+        test.execute(CallbacksFired{counts, 3, 0});
+      }
+
+      {
+        ByteStreamTestHarness test{"default watermarks", 4, storage};
+        auto counts = make_shared<CallbackCounts>();
+
+        test.execute(InstallCallbacks{counts});
+        test.execute(Push{"abc"});
+        test.execute(Pop{1});
+        test.execute(CallbacksFired{counts, 1, 0});
+        test.execute(Push{"defg"});
+        test.execute(AvailableCapacity{0});
+        test.execute(Pop{1});
+        test.execute(CallbacksFired{counts, 1, 1});
+        test.execute(Pop{1});
+        test.execute(CallbacksFired{counts, 1, 1});
+      }
+
+      {
+        ByteStreamTestHarness test{"custom watermarks", 10, storage};
+        auto counts = make_shared<CallbackCounts>();
+
+        test.execute(InstallCallbacks{counts});
+        test.execute(SetWatermarks{2, 6});
+        test.execute(Push{"abcde"});
+        test.execute(Pop{4});
+        test.execute(CallbacksFired{counts, 1, 0});
+        test.execute(Push{"fghij"});
+        test.execute(BytesBuffered{6});
+        test.execute(Pop{3});
+        test.execute(CallbacksFired{counts, 1, 0});
+        test.execute(Pop{1});
+        test.execute(CallbacksFired{counts, 1, 1});
+        test.execute(Pop{2});
+        test.execute(BufferEmpty{true});
+        test.execute(CallbacksFired{counts, 1, 1});
+      }
+
+      {
+        ByteStreamTestHarness test{"error wakes both sides", 10, storage};
+        auto counts = make_shared<CallbackCounts>();
+
+        test.execute(InstallCallbacks{counts});
+        test.execute(SetError{});
+        test.execute(CallbacksFired{counts, 1, 1});
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "parser.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Helpers for tests that check a condition at a time, or run two TCPPeers against each other
+// without the step-by-step harnesses.
+
+inline void expect(bool condition, const std::string &what) {
+  if (not condition) {
+    throw std::runtime_error(what);
+  }
+}
+
+inline void expect_between(uint64_t value, uint64_t min, uint64_t max, const std::string &what) {
+  expect(value >= min and value <= max, what + " was " + std::to_string(value) +
+                                            ", expected between " + std::to_string(min) + " and " +
+                                            std::to_string(max));
+}
+
+// Serialize and re-parse, as the network would
+inline TCPSegment over_the_wire(TCPSegment seg) {
+  seg.compute_checksum(0);
+  TCPSegment parsed;
+  expect(parse(parsed, serialize(seg), 0), "segment failed to parse");
+  return parsed;
+}
+
+// Deliver what `a` has to send to `b`, then `b`'s replies to `a`, recording what went each way.
+// Returns whether anything was sent.
+inline bool round_trip(TCPPeer &a, TCPPeer &b, std::vector<TCPSegment> &a_to_b,
+                       std::vector<TCPSegment> &b_to_a) {
+  bool sent = false;
+  while (auto seg = a.maybe_send()) {
+    a_to_b.push_back(over_the_wire(seg.value()));
+    b.receive(a_to_b.back());
+    sent = true;
+  }
+  while (auto seg = b.maybe_send()) {
+    b_to_a.push_back(over_the_wire(seg.value()));
+    a.receive(b_to_a.back());
+    sent = true;
+  }
+  return sent;
+}
+
+// Exchange segments until neither peer has anything to send
+inline void exchange(TCPPeer &a, TCPPeer &b, std::vector<TCPSegment> &a_to_b,
+                     std::vector<TCPSegment> &b_to_a) {
+  while (round_trip(a, b, a_to_b, b_to_a)) {}
+}
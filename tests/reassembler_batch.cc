@@ -0,0 +1,69 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    for (const auto engine : {Reassembler::Engine::Intervals, Reassembler::Engine::Bitmap}) {
+      {
+        // Out-of-order arrivals that complete the stream's prefix go out as one push.
+        ReassemblerTestHarness test{"in-order batch is coalesced", 100, engine};
+
+        test.execute(InsertBatch{{Insert{"efgh", 4}, Insert{"abcd", 0}, Insert{"ijkl", 8}}});
+        test.execute(BytesPending{0});
+        test.execute(PeekAll{{"abcdefghijkl"}});
+        test.execute(ReadAll("abcdefghijkl"));
+      }
+
+      {
+        // A single in-order substring is passed through as is.
+        ReassemblerTestHarness test{"single-substring batch", 100, engine};
+
+        test.execute(InsertBatch{{Insert{"ab", 0}}});
+        test.execute(InsertBatch{{Insert{"cd", 2}}});
+        test.execute(PeekAll{{"ab", "cd"}});
+      }
+
+      {
+        ReassemblerTestHarness test{"batch with holes", 100, engine};
+
+        test.execute(InsertBatch{{Insert{"gh", 6}, Insert{"ab", 0}, Insert{"cd", 2}}});
+        test.execute(BytesPending{2});
+        test.execute(PendingRanges{4, {{6, 8}}});
+        test.execute(ReadAll("abcd"));
+        test.execute(InsertBatch{{Insert{"ij", 8}.is_last(), Insert{"ef", 4}}});
+        test.execute(BytesPending{0});
+        test.execute(ReadAll("efghij"));
+        test.execute(IsFinished{true});
+      }
+
+      {
+        ReassemblerTestHarness test{"batch fills stored bytes", 100, engine};
+
+        test.execute(Insert{"def", 3});
+        test.execute(InsertBatch{{Insert{"bcdefg", 1}, Insert{"ab", 0}, Insert{"b", 1}}});
+        test.execute(BytesPending{0});
+        test.execute(ReadAll("abcdefg"));
+      }
+
+      {
+        ReassemblerTestHarness test{"batch respects capacity", 4, engine};
+
+        test.execute(InsertBatch{{Insert{"cdef", 2}, Insert{"ab", 0}, Insert{"gh", 6}}});
+        test.execute(BytesPending{0});
+        test.execute(ReadAll("abcd"));
+        test.execute(InsertBatch{{Insert{"efgh", 4}.is_last()}});
+        test.execute(ReadAll("efgh"));
+        test.execute(IsFinished{true});
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
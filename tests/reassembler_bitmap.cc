@@ -0,0 +1,159 @@
+#include "reassembler_test_harness.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+namespace {
+
+constexpr auto BITMAP = Reassembler::Engine::Bitmap;
+
+// Feed the same random, overlapping, out-of-order substrings to both engines and check that
+// they agree with each other and with the original data after every insert.
+void differential(size_t capacity, size_t max_chunk, unsigned seed) {
+  default_random_engine rd{seed};
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret(capacity * 20, '\0');
+    generate(ret.begin(), ret.end(), [&] { return ud(rd); });
+    return ret;
+  }();
+
+  ByteStream intervals_stream{capacity};
+  ByteStream bitmap_stream{capacity};
+  Reassembler intervals;
+  Reassembler bitmap{BITMAP};
+  string intervals_output;
+  string bitmap_output;
+
+  array<Reassembler::Range, Reassembler::MAX_RECENT_RANGES> intervals_ranges{};
+  array<Reassembler::Range, Reassembler::MAX_RECENT_RANGES> bitmap_ranges{};
+
+  while (not bitmap_stream.reader().is_finished()) {
+    const uint64_t first_unassembled = bitmap_stream.writer().bytes_pushed();
+    const uint64_t first_index = min(
+        data.size() - 1, first_unassembled + uniform_int_distribution<uint64_t>{0, capacity}(rd));
+    const uint64_t len =
+        min(data.size() - first_index, uniform_int_distribution<uint64_t>{1, max_chunk}(rd));
+    const bool is_last = first_index + len == data.size();
+
+    intervals.insert(first_index, data.substr(first_index, len), is_last,
+                     intervals_stream.writer());
+    bitmap.insert(first_index, data.substr(first_index, len), is_last, bitmap_stream.writer());
+
+    const size_t num_intervals_ranges = intervals.pending_ranges(intervals_ranges);
+    const size_t num_bitmap_ranges = bitmap.pending_ranges(bitmap_ranges);
+    if (intervals.bytes_pending() != bitmap.bytes_pending() or
+        num_intervals_ranges != num_bitmap_ranges or
+        not equal(intervals_ranges.begin(), intervals_ranges.begin() + num_intervals_ranges,
+                  bitmap_ranges.begin(), [](auto a, auto b) {
+                    return a.begin == b.begin and a.end == b.end;
+                  })) {
+      throw runtime_error("engines disagree after inserting [" + to_string(first_index) + ", " +
+                          to_string(first_index + len) + ")");
+    }
+
+    // Drain the output in random amounts so the window slides unevenly.
+    const uint64_t to_pop = uniform_int_distribution<uint64_t>{0, capacity}(rd);
+    for (auto [stream, output] : {pair{&intervals_stream, &intervals_output},
+                                  pair{&bitmap_stream, &bitmap_output}}) {
+      string chunk;
+      read(stream->reader(), to_pop, chunk);
+      *output += chunk;
+    }
+    if (intervals_output != bitmap_output or
+        bitmap_output != string_view{data}.substr(0, bitmap_output.size())) {
+      throw runtime_error("engines produced different output");
+    }
+  }
+
+  if (bitmap_output != data or not intervals_stream.reader().is_finished()) {
+    throw runtime_error("bitmap engine did not reassemble the whole stream");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    {
+      ReassemblerTestHarness test{"bitmap: holes", 100, BITMAP};
+
+      test.execute(Insert{"b", 1});
+      test.execute(Insert{"d", 3});
+      test.execute(BytesPending{2});
+      test.execute(Insert{"abc", 0});
+      test.execute(ReadAll("abcd"));
+      test.execute(BytesPending{0});
+      test.execute(Insert{"e", 4}.is_last());
+      test.execute(ReadAll("e"));
+      test.execute(IsFinished{true});
+    }
+
+    {
+      ReassemblerTestHarness test{"bitmap: capacity", 2, BITMAP};
+
+      test.execute(Insert{"ab", 0});
+      test.execute(Insert{"cd", 2});
+      test.execute(BytesPending{0});
+      test.execute(ReadAll("ab"));
+      test.execute(Insert{"cd", 2});
+      test.execute(Insert{"ef", 4}.is_last());
+      test.execute(ReadAll("cd"));
+      test.execute(Insert{"ef", 4}.is_last());
+      test.execute(ReadAll("ef"));
+      test.execute(IsFinished{true});
+    }
+
+    {
+      // Stored bytes wrap around the end of the ring as the window slides.
+      ReassemblerTestHarness test{"bitmap: wraparound", 64, BITMAP};
+
+      test.execute(Insert{string(60, 'a'), 0});
+      test.execute(ReadAll(string(60, 'a')));
+      test.execute(Insert{string(10, 'c'), 70});
+      test.execute(PendingRanges{4, {{70, 80}}});
+      test.execute(Insert{string(10, 'b'), 60});
+      test.execute(ReadAll(string(10, 'b') + string(10, 'c')));
+      test.execute(BytesPending{0});
+    }
+
+    {
+      ReassemblerTestHarness test{"bitmap: pending ranges", 100, BITMAP};
+
+      test.execute(Insert{"cd", 2});
+      test.execute(Insert{"gh", 6});
+      test.execute(Insert{"k", 10});
+      test.execute(PendingRanges{4, {{10, 11}, {6, 8}, {2, 4}}});
+      test.execute(Insert{"efg", 4});
+      test.execute(PendingRanges{4, {{2, 8}, {10, 11}}});
+      test.execute(BytesPending{7});
+    }
+
+    {
+      // The ring grows when the stream's capacity does, keeping what it has stored.
+      ReassemblerTestHarness test{"bitmap: capacity grows", 64, BITMAP};
+
+      test.execute(Insert{"xyz", 40});
+      test.execute(SetCapacity{1000});
+      test.execute(Insert{"q", 500});
+      test.execute(PendingRanges{4, {{500, 501}, {40, 43}}});
+      test.execute(Insert{string(40, 'a'), 0});
+      test.execute(ReadAll(string(40, 'a') + "xyz"));
+      test.execute(BytesPending{1});
+    }
+
+    differential(64, 16, 1);
+    differential(100, 40, 2);
+    differential(1000, 300, 3);
+    differential(4096, 1500, 4);
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    {
+      // Out-of-order payloads are held as slices of the original Buffers and handed to the
+      // stream without being copied.
+      ByteStream stream{100};
+      Reassembler reassembler;
+
+      const Buffer first{"abcd"};
+      const Buffer second{"cdefgh"};
+      const Buffer third{"ghij"};
+
+      reassembler.insert(6, third, true, stream.writer());
+      reassembler.insert(2, second, false, stream.writer());
+      if (reassembler.bytes_pending() != 8) {
+        throw runtime_error("expected 8 bytes pending, found " +
+                            to_string(reassembler.bytes_pending()));
+      }
+      reassembler.insert(0, first, false, stream.writer());
+
+      vector<string_view> views;
+      stream.reader().peek_all(views);
+      const vector<const char *> expected{
+          string_view{first}.data(), string_view{second}.data(), string_view{third}.data()};
+      if (views.size() != expected.size() or views[0] != "ab" or views[1] != "cdef" or
+          views[2] != "ghij") {
+        throw runtime_error("reassembled stream does not hold the expected slices");
+      }
+      for (size_t i = 0; i < views.size(); i++) {
+        if (views[i].data() != expected[i]) {
+          throw runtime_error("reassembled slice " + to_string(i) + " was copied");
+        }
+      }
+      if (reassembler.bytes_pending() != 0 or not stream.writer().is_closed()) {
+        throw runtime_error("reassembler did not flush and close the stream");
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+  try {
+    {
+      ReassemblerTestHarness test{"no holes", 100};
+
+      test.execute(PendingRanges{4, {}});
+      test.execute(Insert{"abc", 0});
+      test.execute(PendingRanges{4, {}});
+    }
+
+    {
+      ReassemblerTestHarness test{"most recent first", 100};
+
+      test.execute(Insert{"cd", 2});
+      test.execute(PendingRanges{4, {{2, 4}}});
+      test.execute(Insert{"gh", 6});
+      test.execute(PendingRanges{4, {{6, 8}, {2, 4}}});
+      test.execute(Insert{"k", 10});
+      test.execute(PendingRanges{4, {{10, 11}, {6, 8}, {2, 4}}});
+      test.execute(PendingRanges{2, {{10, 11}, {6, 8}}});
+      test.execute(Insert{"d", 3});
+      test.execute(PendingRanges{4, {{2, 4}, {10, 11}, {6, 8}}});
+    }
+
+    {
+      ReassemblerTestHarness test{"touching substrings merge", 100};
+
+      test.execute(Insert{"cd", 2});
+      test.execute(Insert{"ij", 8});
+      test.execute(Insert{"ef", 4});
+      test.execute(PendingRanges{4, {{2, 6}, {8, 10}}});
+      test.execute(Insert{"fgh", 5});
+      test.execute(PendingRanges{4, {{2, 10}}});
+      test.execute(BytesPending{8});
+    }
+
+    {
+      ReassemblerTestHarness test{"assembled ranges disappear", 100};
+
+      test.execute(Insert{"cd", 2});
+      test.execute(Insert{"gh", 6});
+      test.execute(Insert{"ab", 0});
+      test.execute(PendingRanges{4, {{6, 8}}});
+      test.execute(Insert{"ef", 4});
+      test.execute(PendingRanges{4, {}});
+      test.execute(ReadAll("abcdefgh"));
+    }
+
+    {
+      ReassemblerTestHarness test{"older ranges fill the remaining slots", 100};
+
+      for (uint64_t i = 1; i <= 6; i++) {
+        test.execute(Insert{"x", 2 * i});
+      }
+      test.execute(PendingRanges{6, {{12, 13}, {10, 11}, {8, 9}, {6, 7}, {2, 3}, {4, 5}}});
+    }
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
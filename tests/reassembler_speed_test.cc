@@ -8,7 +8,9 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <span>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -86,7 +88,242 @@ void speed_test(const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-p
   }
 }
 
-void program_body() { speed_test(10000, 1500, 1370); }
+// Reassemble a stream window by window. Within each window, every odd-numbered chunk arrives
+// first (leaving capacity / (2 * chunk_size) holes), then the even-numbered chunks fill the holes
+// in random order.
+void holes_speed_test(const size_t num_windows,  // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t chunk_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t random_seed)  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  default_random_engine rd{random_seed};
+
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for (size_t i = 0; i < num_windows * capacity; ++i) {
+      ret += ud(rd);
+    }
+    return ret;
+  }();
+
+  vector<tuple<uint64_t, string, bool>> split_data;
+  for (size_t window = 0; window < data.size(); window += capacity) {
+    vector<uint64_t> odd;
+    vector<uint64_t> even;
+    for (size_t i = window; i < window + capacity; i += chunk_size) {
+      (((i - window) / chunk_size) % 2 ? odd : even).push_back(i);
+    }
+    shuffle(even.begin(), even.end(), rd);
+    for (const auto &order : {odd, even}) {
+      for (const uint64_t i : order) {
+        split_data.emplace_back(i, data.substr(i, chunk_size), i + chunk_size >= data.size());
+      }
+    }
+  }
+
+  ByteStream stream{capacity};
+  Reassembler reassembler;
+
+  string output_data;
+  output_data.reserve(data.size());
+
+  const auto start_time = steady_clock::now();
+  for (auto &[first_index, chunk, is_last] : split_data) {
+    reassembler.insert(first_index, move(chunk), is_last, stream.writer());
+    stream.reader().pop_all_into(output_data);
+  }
+  const auto stop_time = steady_clock::now();
+
+  if (not stream.reader().is_finished()) {
+    throw runtime_error("Reassembler did not close ByteStream when finished");
+  }
+
+  if (data != output_data) {
+    throw runtime_error("Mismatch between data written and read");
+  }
+
+  auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+  auto bytes_per_second = static_cast<double>(data.size()) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  cout << "Reassembler with capacity=" << capacity << " and " << capacity / (2 * chunk_size)
+       << " holes per window reached " << fixed << setprecision(2) << gigabits_per_second
+       << " Gbit/s.\n";
+
+  debug_output << "     Reassembler throughput with holes: " << fixed << setprecision(2)
+               << gigabits_per_second << " Gbit/s\n";
+
+  if (gigabits_per_second < 0.1) {
+    throw runtime_error("Reassembler did not meet minimum speed of 0.1 Gbit/s with holes.");
+  }
+}
+
+// Reassemble a stream of `chunk_size` chunks where a fraction `reorder_rate` of the chunks swap
+// places with one up to 16 positions later, as on a path with mild reordering. Each engine gets
+// the same arrival order.
+void engine_speed_test(const Reassembler::Engine engine,
+                       const size_t chunk_size,  // NOLINT(bugprone-easily-swappable-parameters)
+                       const double reorder_rate,
+                       const size_t random_seed)  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  constexpr size_t capacity = 65536;
+  constexpr size_t max_displacement = 16;
+  default_random_engine rd{random_seed};
+
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for (size_t i = 0; i < 64 * 1024 * 1024; ++i) {
+      ret += ud(rd);
+    }
+    return ret;
+  }();
+
+  vector<uint64_t> order;
+  for (size_t i = 0; i < data.size(); i += chunk_size) {
+    order.push_back(i);
+  }
+  bernoulli_distribution reorder{reorder_rate};
+  uniform_int_distribution<size_t> displacement{1, max_displacement};
+  for (size_t i = 0; i + max_displacement < order.size(); i++) {
+    if (reorder(rd)) {
+      swap(order[i], order[i + displacement(rd)]);
+    }
+  }
+
+  vector<tuple<uint64_t, string, bool>> split_data;
+  split_data.reserve(order.size());
+  for (const uint64_t i : order) {
+    split_data.emplace_back(i, data.substr(i, chunk_size), i + chunk_size >= data.size());
+  }
+
+  ByteStream stream{capacity};
+  Reassembler reassembler{engine};
+
+  string output_data;
+  output_data.reserve(data.size());
+
+  const auto start_time = steady_clock::now();
+  for (auto &[first_index, chunk, is_last] : split_data) {
+    reassembler.insert(first_index, move(chunk), is_last, stream.writer());
+    stream.reader().pop_all_into(output_data);
+  }
+  const auto stop_time = steady_clock::now();
+
+  if (not stream.reader().is_finished() or data != output_data) {
+    throw runtime_error("Reassembler engine did not reassemble the stream");
+  }
+
+  auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+  auto gigabits_per_second = 8 * static_cast<double>(data.size()) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  const string name = engine == Reassembler::Engine::Bitmap ? "bitmap" : "intervals";
+  cout << "Reassembler (" << name << " engine) with " << chunk_size << "-byte chunks and "
+       << fixed << setprecision(0) << reorder_rate * 100 << "% reordering reached "
+       << setprecision(2) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "  " << setw(9) << name << " engine, " << setw(4) << chunk_size << " B, "
+               << setw(4) << setprecision(0) << reorder_rate * 100 << "% reordered: "
+               << setprecision(2) << gigabits_per_second << " Gbit/s\n";
+
+  if (gigabits_per_second < 0.1) {
+    throw runtime_error("Reassembler engine did not meet minimum speed of 0.1 Gbit/s.");
+  }
+}
+
+// Reassemble 64-byte segments that arrive in bursts of `batch_size` (as from one recvmmsg or GRO
+// batch), with a few swapped within each burst. A batch size of 1 uses insert(); larger batches
+// use insert_batch().
+void batch_speed_test(const size_t batch_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t random_seed)  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  constexpr size_t chunk_size = 64;
+  default_random_engine rd{random_seed};
+
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for (size_t i = 0; i < 64 * 1024 * 1024; ++i) {
+      ret += ud(rd);
+    }
+    return ret;
+  }();
+
+  vector<Reassembler::Substring> substrings;
+  for (size_t i = 0; i < data.size(); i += chunk_size) {
+    substrings.push_back({i, Buffer{data.substr(i, chunk_size)}, i + chunk_size >= data.size()});
+  }
+  bernoulli_distribution reorder{0.05};
+  for (size_t i = 0; i + 1 < substrings.size(); i++) {
+    if ((i + 1) % batch_size and reorder(rd)) {
+      swap(substrings[i], substrings[i + 1]);
+    }
+  }
+
+  ByteStream stream{65536};
+  Reassembler reassembler;
+
+  string output_data;
+  output_data.reserve(data.size());
+
+  const auto start_time = steady_clock::now();
+  for (size_t i = 0; i < substrings.size(); i += batch_size) {
+    if (batch_size == 1) {
+      auto &[first_index, chunk, is_last] = substrings[i];
+      reassembler.insert(first_index, move(chunk), is_last, stream.writer());
+    } else {
+      reassembler.insert_batch(
+          span{substrings}.subspan(i, min(batch_size, substrings.size() - i)), stream.writer());
+    }
+    stream.reader().pop_all_into(output_data);
+  }
+  const auto stop_time = steady_clock::now();
+
+  if (not stream.reader().is_finished() or data != output_data) {
+    throw runtime_error("Reassembler did not reassemble the batched stream");
+  }
+
+  auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+  auto gigabits_per_second = 8 * static_cast<double>(data.size()) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  cout << "Reassembler with " << chunk_size << "-byte segments in batches of " << batch_size
+       << " reached " << fixed << setprecision(2) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "  batches of " << setw(2) << batch_size << ": " << fixed << setprecision(2)
+               << gigabits_per_second << " Gbit/s\n";
+
+  if (gigabits_per_second < 0.1) {
+    throw runtime_error("Reassembler did not meet minimum speed of 0.1 Gbit/s with batches.");
+  }
+}
+
+void program_body() {
+  speed_test(10000, 1500, 1370);
+  holes_speed_test(200, 64000, 1000, 1370);
+  holes_speed_test(50, 64000, 16, 1370);
+
+  for (const size_t chunk_size : {64, 1000}) {
+    for (const double reorder_rate : {0.01, 0.2}) {
+      for (const auto engine : {Reassembler::Engine::Intervals, Reassembler::Engine::Bitmap}) {
+        engine_speed_test(engine, chunk_size, reorder_rate, 1370);
+      }
+    }
+  }
+
+  batch_speed_test(1, 1370);
+  batch_speed_test(16, 1370);
+}
 
 int main() {
   try {
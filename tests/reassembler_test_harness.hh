@@ -7,6 +7,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using StreamAndReassembler = std::pair<ByteStream, Reassembler>;
 
@@ -25,9 +26,12 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler> {
 
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler> {
  public:
-  ReassemblerTestHarness(std::string test_name, uint64_t capacity)
-      : TestHarness(move(test_name), "capacity=" + std::to_string(capacity),
-                    {ByteStream{capacity}, Reassembler{}}) {}
+  ReassemblerTestHarness(std::string test_name, uint64_t capacity,
+                         Reassembler::Engine engine = Reassembler::Engine::Intervals)
+      : TestHarness(move(test_name),
+                    "capacity=" + std::to_string(capacity) +
+                        (engine == Reassembler::Engine::Bitmap ? ", engine=bitmap" : ""),
+                    {ByteStream{capacity}, Reassembler{engine}}) {}
 
   template <std::derived_from<TestStep<ByteStream>> T>
   void execute(const T &test) {
@@ -68,3 +72,61 @@ struct Insert : public Action<StreamAndReassembler> {
     sr.second.insert(first_index_, data_, is_last_substring_, sr.first.writer());
   }
 };
+
+struct InsertBatch : public Action<StreamAndReassembler> {
+  std::vector<Insert> inserts_;
+
+  explicit InsertBatch(std::vector<Insert> inserts) : inserts_(std::move(inserts)) {}
+
+  std::string description() const override {
+    std::ostringstream ss;
+    ss << "insert batch {";
+    for (const auto &insert : inserts_) {
+      ss << " " << insert.description() << ";";
+    }
+    ss << " }";
+    return ss.str();
+  }
+
+  void execute(StreamAndReassembler &sr) const override {
+    std::vector<Reassembler::Substring> batch;
+    for (const auto &insert : inserts_) {
+      batch.push_back({insert.first_index_, Buffer{insert.data_}, insert.is_last_substring_});
+    }
+    sr.second.insert_batch(batch, sr.first.writer());
+  }
+};
+
+struct PendingRanges : public Expectation<StreamAndReassembler> {
+  size_t max_ranges_;
+  std::vector<Reassembler::Range> ranges_;
+
+  PendingRanges(size_t max_ranges, std::vector<Reassembler::Range> ranges)
+      : max_ranges_(max_ranges), ranges_(std::move(ranges)) {}
+
+  static std::string to_string(const std::vector<Reassembler::Range> &ranges) {
+    std::ostringstream ss;
+    ss << "{";
+    for (const auto &range : ranges) {
+      ss << " [" << range.begin << ", " << range.end << ")";
+    }
+    ss << " }";
+    return ss.str();
+  }
+
+  std::string description() const override {
+    return "pending_ranges(max " + std::to_string(max_ranges_) + ") = " + to_string(ranges_);
+  }
+
+  void execute(StreamAndReassembler &sr) const override {
+    std::vector<Reassembler::Range> got(max_ranges_);
+    got.resize(sr.second.pending_ranges(got));
+    if (not std::equal(got.begin(), got.end(), ranges_.begin(), ranges_.end(),
+                       [](const auto &a, const auto &b) {
+                         return a.begin == b.begin and a.end == b.end;
+                       })) {
+      throw ExpectationViolation{"Expected pending ranges " + to_string(ranges_) +
+                                 ", but found " + to_string(got)};
+    }
+  }
+};
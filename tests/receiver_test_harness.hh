@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -43,10 +44,10 @@ class TCPReceiverTestHarness : public TestHarness<ReceiverSet> {
   using TestHarness<ReceiverSet>::execute;
 };
 
-struct ExpectWindow : public ExpectNumber<ReceiverSet, uint16_t> {
+struct ExpectWindow : public ExpectNumber<ReceiverSet, uint32_t> {
   using ExpectNumber::ExpectNumber;
   std::string name() const override { return "window_size"; }
-  uint16_t value(ReceiverSet &rs) const override {
+  uint32_t value(ReceiverSet &rs) const override {
     return rs.second.send(rs.first.first.writer()).window_size;
   }
 };
@@ -92,6 +93,37 @@ struct HasAckno : public ExpectBool<ReceiverSet> {
   }
 };
 
+// The SACK blocks send() reports with the Reassembler's help, as [left, right) pairs
+struct ExpectSACKBlocks : public Expectation<ReceiverSet> {
+  std::vector<std::pair<Wrap32, Wrap32>> blocks_;
+  explicit ExpectSACKBlocks(std::vector<std::pair<Wrap32, Wrap32>> blocks)
+      : blocks_(std::move(blocks)) {}
+
+  static std::string to_string(const std::vector<std::pair<Wrap32, Wrap32>> &blocks) {
+    std::ostringstream out;
+    out << "[";
+    for (const auto &[left, right] : blocks) {
+      out << " [" << left << ", " << right << ")";
+    }
+    out << " ]";
+    return out.str();
+  }
+
+  std::string description() const override { return "SACK blocks " + to_string(blocks_); }
+
+  void execute(ReceiverSet &rs) const override {
+    const TCPReceiverMessage message = rs.second.send(rs.first.first.writer(), rs.first.second);
+    std::vector<std::pair<Wrap32, Wrap32>> actual;
+    for (const auto &block : message.sacks()) {
+      actual.emplace_back(block.left, block.right);
+    }
+    if (actual != blocks_) {
+      throw ExpectationViolation("TCPReceiver reported SACK blocks " + to_string(actual) +
+                                 ", but expected " + to_string(blocks_));
+    }
+  }
+};
+
 struct SegmentArrives : public Action<ReceiverSet> {
   TCPSenderMessage msg_{};
   HasAckno ackno_expected_{true};
@@ -151,3 +183,28 @@ struct SegmentArrives : public Action<ReceiverSet> {
     return ss.str();
   }
 };
+
+struct SegmentsArrive : public Action<ReceiverSet> {
+  std::vector<SegmentArrives> segments_;
+
+  explicit SegmentsArrive(std::vector<SegmentArrives> segments) : segments_(std::move(segments)) {}
+
+  void execute(ReceiverSet &rs) const override {
+    std::vector<TCPSenderMessage> messages;
+    for (const auto &segment : segments_) {
+      messages.push_back(segment.msg_);
+    }
+    rs.second.receive_batch(messages, rs.first.second, rs.first.first.writer());
+  }
+
+  std::string description() const override {
+    std::ostringstream ss;
+    ss << "receive batch {";
+    for (const auto &segment : segments_) {
+      ss << " " << segment.description().substr(0, segment.description().find(" with ackno"))
+         << ";";
+    }
+    ss << " }";
+    return ss.str();
+  }
+};
@@ -0,0 +1,153 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t RECV_CAPACITY = 10'000;
+constexpr uint64_t RECV_CAPACITY_MAX = 1'000'000;
+constexpr uint8_t WINDOW_SHIFT = 4;  // Enough for RECV_CAPACITY_MAX
+
+// The right edge of the window each of the server's segments advertised (as absolute sequence
+// numbers of the client's stream)
+vector<uint64_t> right_edges(const vector<TCPSegment> &to_client, Wrap32 isn) {
+  vector<uint64_t> edges;
+  for (const auto &seg : to_client) {
+    if (seg.sender_message.SYN or not seg.receiver_message.ackno.has_value()) {
+      continue;
+    }
+    const uint64_t checkpoint = edges.empty() ? 0 : edges.back();
+    const uint64_t ackno = seg.receiver_message.ackno->unwrap(isn, checkpoint);
+    edges.push_back(ackno + (uint64_t{seg.receiver_message.window_size} << WINDOW_SHIFT));
+  }
+  return edges;
+}
+
+// Send the server one byte, and return the window its ACK advertises (plus that byte)
+uint64_t probe_window(TCPPeer &client, TCPPeer &server, Wrap32 isn, vector<TCPSegment> &to_server,
+                      vector<TCPSegment> &to_client) {
+  const uint64_t acked = server.inbound_reader().bytes_popped() + 1;  // The bytes read, and SYN
+  client.outbound_writer().push("y");
+  client.push();
+  exchange(client, server, to_server, to_client);
+  const uint64_t window = right_edges(to_client, isn).back() - acked;
+  server.inbound_reader().pop(1);
+  return window;
+}
+
+// A reader that keeps up grows the server's window to twice what it reads per round trip (here,
+// per millisecond); once grown, the window stays so through idle time, and its right edge never
+// moves back. The client sends less than the initial window each time, since the server sends
+// no window update when its reader makes room.
+void autotune_test(Wrap32 isn) {
+  constexpr uint64_t RATE = 8'000;  // Bytes the client sends, and the server reads, per ms
+
+  TCPConfig client_cfg;
+  client_cfg.fixed_isn = isn;
+  client_cfg.window_scaling = true;
+
+  TCPConfig server_cfg;
+  server_cfg.window_scaling = true;
+  server_cfg.recv_capacity = RECV_CAPACITY;
+  server_cfg.recv_capacity_max = RECV_CAPACITY_MAX;
+
+  TCPPeer client{client_cfg};
+  TCPPeer server{server_cfg};
+  vector<TCPSegment> to_server;
+  vector<TCPSegment> to_client;
+
+  client.push();
+  exchange(client, server, to_server, to_client);
+  expect(to_client.front().window_scale == WINDOW_SHIFT, "server's SYN offered the wrong shift");
+
+  for (int i = 0; i < 100; i++) {
+    client.outbound_writer().push(string(RATE, 'x'));
+    client.push();
+    exchange(client, server, to_server, to_client);
+    expect(server.inbound_reader().bytes_buffered() == RATE, "window throttled the client");
+    server.inbound_reader().pop(RATE);
+    client.tick(1);
+    server.tick(1);
+  }
+  // (Scaled windows are rounded down, so the window can fall short by up to 1 << WINDOW_SHIFT.)
+  const uint64_t grown = probe_window(client, server, isn, to_server, to_client);
+  expect(grown + (1 << WINDOW_SHIFT) > 2 * RATE, "window grew to " + to_string(grown) + " bytes");
+
+  // Idle for a while: the window is as large as it was.
+  for (int i = 0; i < 100; i++) {
+    client.tick(10);
+    server.tick(10);
+    exchange(client, server, to_server, to_client);
+  }
+  const uint64_t idle = probe_window(client, server, isn, to_server, to_client);
+  expect(idle + (1 << WINDOW_SHIFT) > grown, "window shrank to " + to_string(idle) + " bytes");
+
+  uint64_t furthest = 0;
+  for (const uint64_t edge : right_edges(to_client, isn)) {
+    expect(edge + (1 << WINDOW_SHIFT) > furthest, "window's right edge moved back");
+    furthest = max(furthest, edge);
+  }
+}
+
+// The sampling interval is a round trip, once there is an RTT sample to go by.
+void interval_test(Wrap32 isn) {
+  TCPConfig client_cfg;
+  client_cfg.fixed_isn = isn;
+  TCPConfig server_cfg;
+  server_cfg.recv_capacity_max = 2 * server_cfg.recv_capacity;
+  server_cfg.recv_autotune_interval_ms = 10;
+
+  TCPPeer client{client_cfg};
+  TCPPeer server{server_cfg};
+  vector<TCPSegment> to_server;
+  vector<TCPSegment> to_client;
+
+  client.push();
+  exchange(client, server, to_server, to_client);
+  server.tick(server.next_timeout_ms().value());
+  expect(server.next_timeout_ms() == 1, "an RTT of 0 ms should sample every millisecond");
+
+  // A 200 ms round trip: SRTT = 0 + (200 - 0) / 8
+  server.outbound_writer().push(string(100, 'x'));
+  server.push();
+  auto seg = server.maybe_send();
+  expect(seg.has_value(), "server sent no data");
+  server.tick(200);
+  client.tick(200);
+  client.receive(over_the_wire(seg.value()));
+  exchange(client, server, to_server, to_client);
+  expect(server.sender().smoothed_RTT_ms() == 25, "wrong SRTT");
+
+  server.tick(server.next_timeout_ms().value());
+  expect(server.next_timeout_ms() == 25, "sampling interval not the SRTT");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    autotune_test(Wrap32(rd()));
+    interval_test(Wrap32(rd()));
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+      TCPReceiverTestHarness test{"batch starting with SYN", 4000};
+      test.execute(SegmentsArrive{{SegmentArrives{}.with_syn().with_seqno(isn).with_data("ab"),
+                                   SegmentArrives{}.with_seqno(isn + 5).with_data("ef"),
+                                   SegmentArrives{}.with_seqno(isn + 3).with_data("cd")}});
+      test.execute(ExpectAckno{Wrap32{isn + 7}});
+      test.execute(BytesPending{0});
+      test.execute(PeekAll{{"abcdef"}});
+      test.execute(ReadAll{"abcdef"});
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+      TCPReceiverTestHarness test{"segments before SYN in a batch", 4000};
+      test.execute(SegmentsArrive{{SegmentArrives{}.with_seqno(isn + 1).with_data("ab"),
+                                   SegmentArrives{}.with_syn().with_seqno(isn),
+                                   SegmentArrives{}.with_seqno(isn + 3).with_data("cd")}});
+      test.execute(ExpectAckno{Wrap32{isn + 1}});
+      test.execute(BytesPending{2});
+      test.execute(SegmentsArrive{{SegmentArrives{}.with_seqno(isn + 1).with_data("ab")}});
+      test.execute(ExpectAckno{Wrap32{isn + 5}});
+      test.execute(ReadAll{"abcd"});
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+      TCPReceiverTestHarness test{"batch with hole and FIN", 4000};
+      test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+      test.execute(SegmentsArrive{{SegmentArrives{}.with_seqno(isn + 7).with_data("gh").with_fin(),
+                                   SegmentArrives{}.with_seqno(isn + 1).with_data("ab"),
+                                   SegmentArrives{}.with_seqno(isn).with_data("x")}});
+      test.execute(ExpectAckno{Wrap32{isn + 3}});
+      test.execute(BytesPending{2});
+      test.execute(IsClosed{false});
+      test.execute(SegmentsArrive{{SegmentArrives{}.with_seqno(isn + 3).with_data("cdef")}});
+      test.execute(ExpectAckno{Wrap32{isn + 10}});
+      test.execute(ReadAll{"abcdefgh"});
+      test.execute(IsClosed{true});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+TCPConfig delayed_ack_config(uint64_t delayed_ack_ms) {
+  TCPConfig cfg;
+  cfg.delayed_ack_ms = delayed_ack_ms;
+  return cfg;
+}
+
+// A TCPPeer that the test hands segments from a (notional) client, after the handshake
+class Server {
+  Wrap32 client_isn_;
+  TCPPeer peer_;
+  optional<Wrap32> server_isn_{};
+
+ public:
+  Server(Wrap32 client_isn, uint64_t delayed_ack_ms)
+      : client_isn_(client_isn), peer_(delayed_ack_config(delayed_ack_ms)) {
+    TCPSegment syn;
+    syn.sender_message = {client_isn_, true, {}, false};
+    peer_.receive(syn);
+    const optional<Wrap32> ackno = expect_ack("SYN-ACK");
+    expect(ackno == client_isn_ + 1, "SYN-ACK has the wrong ackno");
+  }
+
+  TCPPeer &peer() { return peer_; }
+
+  // Send the client's bytes [offset, offset + len), which carry a FIN if `fin`
+  void send(uint64_t offset, uint64_t len, bool fin = false) {
+    TCPSegment seg;
+    seg.sender_message = {client_isn_ + 1 + static_cast<uint32_t>(offset), false, string(len, 'x'),
+                          fin};
+    seg.receiver_message = {server_isn_.value() + 1, UINT16_MAX};
+    peer_.receive(seg);
+  }
+
+  // Expect a segment right away, and return its ackno
+  optional<Wrap32> expect_ack(const string &what) {
+    auto seg = peer_.maybe_send();
+    expect(seg.has_value(), "no ACK for the " + what);
+    if (seg->sender_message.SYN) {
+      server_isn_ = seg->sender_message.seqno;
+    }
+    expect(not peer_.maybe_send().has_value(), "more than one ACK for the " + what);
+    return seg->receiver_message.ackno;
+  }
+
+  void expect_ack(const string &what, uint64_t bytes) {
+    expect(expect_ack(what) == client_isn_ + 1 + static_cast<uint32_t>(bytes),
+           "wrong ackno for the " + what);
+  }
+
+  void expect_no_ack(const string &what) {
+    expect(not peer_.maybe_send().has_value(), "the " + what + " was acknowledged at once");
+  }
+};
+
+void delayed_ack_test(Wrap32 isn) {
+  Server server{isn, 40};
+
+  // Every second in-order segment is acknowledged at once.
+  server.send(0, 1000);
+  server.expect_no_ack("first segment");
+  server.send(1000, 1000);
+  server.expect_ack("second segment", 2000);
+
+  // A lone segment waits for the timer.
+  server.send(2000, 1000);
+  server.expect_no_ack("third segment");
+  expect(server.peer().next_timeout_ms() == 40, "no delayed-ACK timeout");
+  server.peer().tick(39);
+  server.expect_no_ack("third segment, after 39 ms");
+  server.peer().tick(1);
+  server.expect_ack("third segment, after 40 ms", 3000);
+  expect(not server.peer().next_timeout_ms().has_value(), "delayed-ACK timeout left running");
+
+  // Out-of-order data, and the segment that fills the gap, get immediate ACKs.
+  server.send(4000, 1000);
+  server.expect_ack("out-of-order segment", 3000);
+  server.send(3000, 1000);
+  server.expect_ack("segment that filled the gap", 5000);
+
+  // So does the FIN.
+  server.send(5000, 500, true);
+  server.expect_ack("FIN", 5501);
+}
+
+void no_delay_test(Wrap32 isn) {
+  Server server{isn, 0};
+  server.send(0, 1000);
+  server.expect_ack("segment", 1000);
+  server.send(1000, 1000);
+  server.expect_ack("segment", 2000);
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    delayed_ack_test(Wrap32(rd()));
+    no_delay_test(Wrap32(rd()));
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
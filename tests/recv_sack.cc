@@ -0,0 +1,89 @@
+#include "parser.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+void segment_options_test(Wrap32 isn) {
+  TCPSegment segment;
+  segment.udinfo.src_port = 1234;
+  segment.udinfo.dst_port = 80;
+  segment.sender_message = {isn, true, string{"hello"}, false};
+  segment.sack_permitted = true;
+  segment.receiver_message.ackno = isn + 100;
+  segment.receiver_message.window_size = 4000;
+  segment.receiver_message.sack_blocks.at(0) = {isn + 300, isn + 400};
+  segment.receiver_message.sack_blocks.at(1) = {isn + 150, isn + 200};
+  segment.receiver_message.num_sack_blocks = 2;
+  segment.compute_checksum(0);
+
+  TCPSegment parsed;
+  if (not parse(parsed, serialize(segment), 0)) {
+    throw runtime_error("segment with SACK options failed to parse");
+  }
+  const auto &message = parsed.receiver_message;
+  if (not parsed.sack_permitted or message.ackno != segment.receiver_message.ackno or
+      message.window_size != 4000 or message.num_sack_blocks != 2 or
+      message.sack_blocks.at(0).left != isn + 300 or message.sack_blocks.at(0).right != isn + 400 or
+      message.sack_blocks.at(1).left != isn + 150 or message.sack_blocks.at(1).right != isn + 200) {
+    throw runtime_error("segment options did not survive serializing and parsing");
+  }
+  if (static_cast<string>(parsed.sender_message.payload) != "hello" or
+      not parsed.sender_message.SYN) {
+    throw runtime_error("segment with options lost its payload or flags");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+      TCPReceiverTestHarness test{"SACK blocks for out-of-order data, newest first", 4000};
+      test.execute(ExpectSACKBlocks{{}});
+      test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+      test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("cd"));
+      test.execute(ExpectSACKBlocks{{{Wrap32{isn + 3}, Wrap32{isn + 5}}}});
+      test.execute(SegmentArrives{}.with_seqno(isn + 7).with_data("gh"));
+      test.execute(ExpectSACKBlocks{
+          {{Wrap32{isn + 7}, Wrap32{isn + 9}}, {Wrap32{isn + 3}, Wrap32{isn + 5}}}});
+      test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("ef"));
+      test.execute(ExpectSACKBlocks{{{Wrap32{isn + 3}, Wrap32{isn + 9}}}});
+      test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("ab"));
+      test.execute(ExpectAckno{Wrap32{isn + 9}});
+      test.execute(ExpectSACKBlocks{{}});
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+      TCPReceiverTestHarness test{"At most four SACK blocks", 4000};
+      test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+      for (uint32_t i = 1; i <= 6; i++) {
+        test.execute(SegmentArrives{}.with_seqno(isn + 10 * i).with_data("x"));
+      }
+      test.execute(ExpectSACKBlocks{{{Wrap32{isn + 60}, Wrap32{isn + 61}},
+                                     {Wrap32{isn + 50}, Wrap32{isn + 51}},
+                                     {Wrap32{isn + 40}, Wrap32{isn + 41}},
+                                     {Wrap32{isn + 30}, Wrap32{isn + 31}}}});
+    }
+
+    segment_options_test(Wrap32(rd()));
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
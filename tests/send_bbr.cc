@@ -0,0 +1,154 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+const BBR &bbr_of(const TCPSender &sender) {
+  const auto *bbr = dynamic_cast<const BBR *>(sender.congestion_control());
+  if (bbr == nullptr) {
+    throw runtime_error("sender is not using BBR");
+  }
+  return *bbr;
+}
+
+TCPConfig bbr_config(Wrap32 isn, bool pacing = false) {
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.congestion_control = CongestionControl::Algorithm::BBR;
+  cfg.pacing = pacing;
+  return cfg;
+}
+
+// Five segments acknowledged together, 100 ms after they were sent, delivered 5000 bytes in
+// 100 ms.
+void delivery_rate_test(Wrap32 isn) {
+  const TCPConfig cfg = bbr_config(isn);
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  sender.push(stream.reader());
+  sender.tick(100);
+  sender.receive({isn + 1, UINT16_MAX});
+  stream.writer().push(string(5000, 'x'));
+  sender.push(stream.reader());
+  sender.tick(100);
+  sender.receive({isn + 5001, UINT16_MAX});
+
+  expect_between(bbr_of(sender).bottleneck_bandwidth(), 50000, 50000, "bandwidth estimate");
+  expect_between(bbr_of(sender).min_rtt_ms(), 100, 100, "min RTT");
+  if (not bbr_of(sender).pacing_rate().has_value()) {
+    throw runtime_error("BBR has no pacing rate");
+  }
+}
+
+// During fast recovery the model still follows the ACKs, and the window lets the sender put out
+// one new segment for each one delivered.
+void recovery_test(Wrap32 isn) {
+  TCPConfig cfg = bbr_config(isn);
+  cfg.fast_retransmit = true;
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  sender.push(stream.reader());
+  sender.tick(100);
+  sender.receive({isn + 1, UINT16_MAX});
+  expect_between(bbr_of(sender).min_rtt_ms(), 100, 100, "min RTT");
+
+  stream.writer().push(string(10000, 'x'));
+  sender.push(stream.reader());
+  while (sender.maybe_send().has_value()) {}
+  sender.tick(10);
+  for (int i = 0; i < 3; i++) {
+    sender.receive({isn + 1, UINT16_MAX});
+  }
+  if (not sender.maybe_send().has_value()) {
+    throw runtime_error("no fast retransmission");
+  }
+
+  // Acknowledges the retransmitted segment and the one after it, which was sent 20 ms ago: a
+  // partial ACK, and a new minimum RTT.
+  sender.tick(10);
+  sender.receive({isn + 2001, UINT16_MAX});
+  expect_between(bbr_of(sender).min_rtt_ms(), 20, 20, "min RTT during recovery");
+  expect_between(bbr_of(sender).window(), sender.sequence_numbers_in_flight() + 2000, UINT64_MAX,
+                 "window during recovery");
+}
+
+// A bulk transfer over a 1 MB/s bottleneck with 20 ms of propagation delay: BBR should find
+// the link's bandwidth and RTT, and leave Startup once the pipe is full, paced or not.
+void link_test(Wrap32 isn, bool pacing) {
+  constexpr uint64_t BYTES_PER_MS = 1000;
+  constexpr uint64_t ONE_WAY_DELAY_MS = 10;
+
+  const TCPConfig cfg = bbr_config(isn, pacing);
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  struct InFlight {
+    uint64_t ack_at_us;
+    Wrap32 ackno;
+  };
+  deque<InFlight> link;
+  uint64_t link_free_at_us = 0;
+
+  for (uint64_t now_ms = 0; now_ms < 3000; now_ms++) {
+    sender.tick(1);
+    while (not link.empty() and link.front().ack_at_us <= now_ms * 1000) {
+      sender.receive({link.front().ackno, UINT16_MAX});
+      link.pop_front();
+    }
+
+    stream.writer().push(string(stream.writer().available_capacity(), 'x'));
+    sender.push(stream.reader());
+    while (auto message = sender.maybe_send()) {
+      const uint64_t serialization_us = message->sequence_length() * 1000 / BYTES_PER_MS;
+      link_free_at_us = max(link_free_at_us, now_ms * 1000) + serialization_us;
+      link.push_back({link_free_at_us + 2 * ONE_WAY_DELAY_MS * 1000,
+                      message->seqno + static_cast<uint32_t>(message->sequence_length())});
+    }
+  }
+
+  const BBR &bbr = bbr_of(sender);
+  expect_between(bbr.bottleneck_bandwidth(), BYTES_PER_MS * 1000 * 8 / 10,
+                 BYTES_PER_MS * 1000 * 12 / 10, "bandwidth estimate");
+  expect_between(bbr.min_rtt_ms(), 2 * ONE_WAY_DELAY_MS, 2 * ONE_WAY_DELAY_MS + 2, "min RTT");
+  if (bbr.mode() != BBR::Mode::ProbeBW) {
+    throw runtime_error("BBR did not reach ProbeBW");
+  }
+
+  // Paced, BBR keeps about one bandwidth-delay product in flight, rather than queueing another.
+  if (pacing) {
+    const uint64_t bdp = BYTES_PER_MS * 2 * ONE_WAY_DELAY_MS;
+    expect_between(sender.sequence_numbers_in_flight(), bdp, bdp * 3 / 2, "paced in-flight");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    delivery_rate_test(Wrap32(rd()));
+    recovery_test(Wrap32(rd()));
+    link_test(Wrap32(rd()), false);
+    link_test(Wrap32(rd()), true);
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
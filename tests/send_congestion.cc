@@ -0,0 +1,150 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+void expect_window(const CongestionControl &cc, uint64_t min, uint64_t max, const string &when) {
+  if (cc.window() < min or cc.window() > max) {
+    throw runtime_error("congestion window " + to_string(cc.window()) + " " + when +
+                        ", expected between " + to_string(min) + " and " + to_string(max));
+  }
+}
+
+void controller_tests() {
+  {
+    Reno reno{1000};
+    expect_window(reno, 10000, 10000, "initially");
+    reno.on_enter_recovery(10000, 0);
+    expect_window(reno, 8000, 8000, "entering fast recovery");
+    reno.on_recovery_dup_ack();
+    expect_window(reno, 9000, 9000, "after a duplicate ACK in recovery");
+    if (reno.on_partial_ack(1000)) {
+      throw runtime_error("Reno stayed in fast recovery after a partial ACK");
+    }
+    reno.on_exit_recovery();
+    expect_window(reno, 5000, 5000, "leaving fast recovery");
+    for (int i = 0; i < 5; i++) {
+      reno.on_ack(1000, 4000, 0, {});
+    }
+    expect_window(reno, 6000, 6000, "after a window of ACKs in congestion avoidance");
+    reno.on_timeout(6000, 0);
+    expect_window(reno, 1000, 1000, "after a timeout");
+    reno.on_ack(1000, 0, 0, {});
+    expect_window(reno, 2000, 2000, "slow starting after a timeout");
+  }
+
+  {
+    NewReno newreno{1000};
+    newreno.on_enter_recovery(10000, 0);
+    if (not newreno.on_partial_ack(3000)) {
+      throw runtime_error("NewReno left fast recovery on a partial ACK");
+    }
+    expect_window(newreno, 6000, 6000, "after a partial ACK");
+  }
+
+  {
+    // Grow to 100 segments, lose one, then ACK a window every 100 ms RTT.
+    Cubic cubic{1000};
+    while (cubic.window() < 100000) {
+      cubic.on_ack(2000, 0, 0, 100);
+    }
+    cubic.on_enter_recovery(100000, 0);
+    cubic.on_exit_recovery();
+    expect_window(cubic, 70000, 70000, "after a loss");
+
+    for (uint64_t now = 100; now <= 7000; now += 100) {
+      cubic.on_ack(cubic.window(), cubic.window(), now, 100);
+      if (now == 1000) {
+        expect_window(cubic, 80000, 95000, "1 s after the loss (concave region)");
+      } else if (now == 4000) {
+        expect_window(cubic, 97000, 101000, "4 s after the loss (plateau)");
+      }
+    }
+    expect_window(cubic, 105000, 120000, "7 s after the loss (convex region)");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    controller_tests();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test{"No congestion control by default", cfg};
+      test.execute(ExpectCongestionWindow{UINT64_MAX});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, UINT16_MAX}});
+      test.execute(Push{string(20000, 'x')});
+      test.execute(ExpectSeqnosInFlight{20000});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test{"Congestion window limits what is in flight", cfg};
+      test.execute(ExpectCongestionWindow{10000});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{10001});
+      test.execute(Push{string(30000, 'x')});
+      test.execute(ExpectSeqnosInFlight{10001});
+      for (int i = 0; i < 10; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000));
+      }
+      test.execute(ExpectMessage{}.with_payload_size(1));
+      test.execute(ExpectNoSegment{});
+
+      // One ACK for everything grows the window by at most two segments in slow start.
+      test.execute(Receive{{isn + 10002, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{12001});
+      test.execute(ExpectSeqnosInFlight{12001});
+
+      // A timeout collapses the window to one segment.
+      test.execute(Tick{cfg.rt_timeout}.with_max_retx_exceeded(false));
+      test.execute(ExpectCongestionWindow{1000});
+      test.execute(Receive{{isn + 22003, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{3000});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::Cubic;
+
+      TCPSenderTestHarness test{"Receiver window still applies", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 3000}});
+      test.execute(Push{string(30000, 'x')});
+      test.execute(ExpectSeqnosInFlight{3000});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
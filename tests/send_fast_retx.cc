@@ -0,0 +1,165 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+#include "tcp_peer.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test{"Fast retransmit on the third duplicate ACK", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 10000}});
+      test.execute(Push{string(5000, 'x')});
+      for (uint32_t i = 0; i < 5; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+      test.execute(Receive{{isn + 1001, 10000}});
+      test.execute(Receive{{isn + 1001, 10000}});
+      test.execute(Receive{{isn + 1001, 10000}});
+      test.execute(ExpectNoSegment{});
+      test.execute(Receive{{isn + 1001, 10000}});
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1001));
+      test.execute(Receive{{isn + 1001, 10000}});
+      test.execute(ExpectNoSegment{});
+      test.execute(ExpectSeqnosInFlight{4000});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test{"Window updates are not duplicate ACKs", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 10000}});
+      test.execute(Push{string(3000, 'x')});
+      test.execute(Receive{{isn + 1, 9000}});
+      test.execute(Receive{{isn + 1, 8000}});
+      test.execute(Receive{{isn + 1, 7000}});
+      for (uint32_t i = 0; i < 3; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+      test.execute(ExpectNoSegment{});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test{"No fast retransmit for data sent before a timeout", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 10000}});
+      test.execute(Push{string(3000, 'x')});
+      for (uint32_t i = 0; i < 3; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+      test.execute(Tick{cfg.rt_timeout}.with_max_retx_exceeded(false));
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1));
+      for (int i = 0; i < 3; i++) {
+        test.execute(Receive{{isn + 1, 10000}});
+      }
+      test.execute(ExpectNoSegment{});
+    }
+
+    {
+      // The peer's data segments repeat its ackno and window while ours is lost, but only pure
+      // ACKs are duplicate ACKs.
+      TCPConfig client_cfg;
+      client_cfg.fixed_isn = Wrap32(rd());
+      client_cfg.fast_retransmit = true;
+      TCPPeer client{client_cfg};
+      TCPPeer server{TCPConfig{}};
+      vector<TCPSegment> to_server;
+      vector<TCPSegment> to_client;
+
+      client.push();
+      exchange(client, server, to_server, to_client);
+      client.outbound_writer().push(string(1000, 'x'));
+      client.push();
+      expect(client.maybe_send().has_value(), "client sent no data");  // Lost
+
+      server.outbound_writer().push(string(5000, 'y'));
+      server.push();
+      size_t data_segments = 0;
+      while (auto seg = server.maybe_send()) {
+        data_segments++;
+        client.receive(over_the_wire(seg.value()));
+        while (auto reply = client.maybe_send()) {
+          expect(reply->sender_message.payload.empty(), "data segments taken as duplicate ACKs");
+        }
+      }
+      expect(data_segments == 5, "server sent " + to_string(data_segments) + " segments");
+      expect(client.sender().sequence_numbers_in_flight() == 1000, "lost segment not in flight");
+    }
+
+    for (const auto algorithm :
+         {CongestionControl::Algorithm::NewReno, CongestionControl::Algorithm::Reno}) {
+      const bool newreno = algorithm == CongestionControl::Algorithm::NewReno;
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = algorithm;
+
+      TCPSenderTestHarness test{
+          string{newreno ? "NewReno" : "Reno"} + " fast recovery with two segments lost", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, UINT16_MAX}});
+      test.execute(Push{string(10000, 'x')});
+      for (uint32_t i = 0; i < 10; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+
+      // The second and fourth segments are lost.
+      test.execute(Receive{{isn + 1001, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{11001});
+      for (int i = 0; i < 3; i++) {
+        test.execute(Receive{{isn + 1001, UINT16_MAX}});
+      }
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1001));
+      test.execute(ExpectCongestionWindow{7500});  // ssthresh = 9000 / 2, plus three segments
+      test.execute(Receive{{isn + 1001, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{8500});
+
+      // The retransmission fills the first hole: the ACK is partial.
+      test.execute(Receive{{isn + 3001, UINT16_MAX}});
+      if (newreno) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 3001));
+        test.execute(ExpectCongestionWindow{7500});
+        test.execute(Receive{{isn + 10001, UINT16_MAX}});
+      }
+      test.execute(ExpectCongestionWindow{4500});
+      test.execute(ExpectNoSegment{});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+#include "tcp_over_ip.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+TCPSenderMessage expect_message(TCPSender &sender, Wrap32 seqno, size_t payload_size) {
+  auto message = sender.maybe_send();
+  expect(message.has_value(), "no message");
+  expect(message->seqno == seqno, "wrong sequence number");
+  expect(message->payload.size() == payload_size,
+         "payload was " + to_string(message->payload.size()) + " bytes, expected " +
+             to_string(payload_size));
+  return message.value();
+}
+
+// The sender fills the window with super-segments, and resends a lost one an MSS at a time.
+void sender_test(Wrap32 isn) {
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.large_send = true;
+  cfg.send_capacity = 200'000;
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  sender.push(stream.reader());
+  expect(expect_message(sender, isn, 0).SYN, "no SYN");
+  sender.receive({isn + 1, UINT16_MAX});
+
+  stream.writer().push(string(100'000, 'x'));
+  sender.push(stream.reader());
+  expect_message(sender, isn + 1, TCPConfig::MAX_SUPER_SEGMENT_SIZE);
+  expect_message(sender, isn + 1 + TCPConfig::MAX_SUPER_SEGMENT_SIZE,
+                 UINT16_MAX - TCPConfig::MAX_SUPER_SEGMENT_SIZE);
+  expect(not sender.maybe_send().has_value(), "sent beyond the window");
+
+  sender.tick(cfg.rt_timeout);
+  expect_message(sender, isn + 1, TCPConfig::MAX_PAYLOAD_SIZE);
+  expect(not sender.maybe_send().has_value(), "retransmitted more than one MSS");
+
+  // Part of the rest arrived: the next retransmission starts after it.
+  sender.receive({isn + 3001, UINT16_MAX});
+  expect(sender.sequence_numbers_in_flight() == UINT16_MAX - 3000, "wrong in-flight count");
+  sender.tick(cfg.rt_timeout);
+  expect_message(sender, isn + 3001, TCPConfig::MAX_PAYLOAD_SIZE);
+
+  sender.receive({isn + 1 + UINT16_MAX, UINT16_MAX});
+  expect(sender.sequence_numbers_in_flight() == 0, "super-segments not all acknowledged");
+}
+
+// The adapter splits a super-segment into MSS-sized datagrams, each with a valid checksum.
+void adapter_test(Wrap32 isn, const string &data) {
+  TCPOverIPv4Adapter adapter;
+  adapter.config_mut().source = Address{"10.0.0.1", 1234};
+  adapter.config_mut().destination = Address{"10.0.0.2", 5678};
+
+  TCPSegment seg;
+  seg.sender_message = {isn, false, data, true};
+  seg.receiver_message.ackno = isn + 12345;
+  seg.receiver_message.window_size = 5000;
+  seg.receiver_message.sack_blocks.at(0) = {isn + 20000, isn + 21000};  // Options, too
+  seg.receiver_message.num_sack_blocks = 1;
+  const vector<InternetDatagram> datagrams = adapter.wrap_tcp_in_ip(seg);
+  const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+  expect(datagrams.size() == (data.size() + mss - 1) / mss, "wrong number of datagrams");
+
+  string reassembled;
+  for (size_t i = 0; i < datagrams.size(); i++) {
+    InternetDatagram ip_dgram;
+    expect(parse(ip_dgram, serialize(datagrams[i])), "bad IP header");
+    TCPSegment tcp_seg;
+    expect(parse(tcp_seg, ip_dgram.payload, ip_dgram.header.pseudo_checksum()),
+           "bad TCP checksum in segment " + to_string(i));
+
+    const TCPSenderMessage &message = tcp_seg.sender_message;
+    expect(message.seqno == isn + static_cast<uint32_t>(reassembled.size()), "wrong seqno");
+    expect(message.FIN == (i + 1 == datagrams.size()), "FIN not on the last segment only");
+    expect(tcp_seg.receiver_message.ackno == isn + 12345, "wrong ackno");
+    expect(tcp_seg.receiver_message.window_size == 5000, "wrong window");
+    expect(tcp_seg.receiver_message.num_sack_blocks == 1, "SACK block missing");
+    expect(tcp_seg.udinfo.src_port == 1234 and tcp_seg.udinfo.dst_port == 5678, "wrong ports");
+    reassembled += static_cast<string_view>(message.payload);
+  }
+  expect(reassembled == data, "payloads don't add up to the super-segment's");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    sender_test(Wrap32(rd()));
+
+    string data(TCPConfig::MAX_SUPER_SEGMENT_SIZE - 500, 0);
+    for (auto &c : data) {
+      c = static_cast<char>(rd());
+    }
+    adapter_test(Wrap32(rd()), data);
+    adapter_test(Wrap32(rd()), data.substr(0, 2 * TCPConfig::MAX_PAYLOAD_SIZE + 1));
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include "byte_stream.hh"
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// The sender says when its retransmission timer and pacing schedule next need a tick().
+void sender_test(Wrap32 isn) {
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  expect(not sender.next_timeout_ms().has_value(), "timeout with nothing sent");
+  sender.push(stream.reader());
+  expect(sender.maybe_send().has_value(), "no SYN");
+  expect(sender.next_timeout_ms() == cfg.rt_timeout, "SYN's timeout isn't the RTO");
+  sender.tick(cfg.rt_timeout - 1);
+  expect(sender.next_timeout_ms() == 1, "timeout not counting down");
+  sender.tick(1);
+  expect(sender.maybe_send().has_value(), "SYN not retransmitted on time");
+  expect(sender.next_timeout_ms() == 2 * cfg.rt_timeout, "timeout not backed off");
+  sender.receive({isn + 1, 10000});
+  expect(not sender.next_timeout_ms().has_value(), "timeout with nothing in flight");
+
+  TCPConfig paced = cfg;
+  paced.pacing = true;
+  paced.pacing_rate = 100'000;  // A segment every 10 ms
+  TCPSender pacer{paced};
+  pacer.push(stream.reader());
+  pacer.maybe_send();
+  pacer.receive({isn + 1, 10000});
+  stream.writer().push(string(2000, 'x'));
+  for (const uint64_t gap : {1, 10}) {
+    pacer.push(stream.reader());
+    expect(not pacer.maybe_send().has_value(), "segment not paced");
+    expect(pacer.next_timeout_ms() == gap, "wrong pacing timeout");
+    pacer.tick(gap);
+    pacer.push(stream.reader());
+    expect(pacer.maybe_send().has_value(), "segment not released on time");
+  }
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    sender_test(Wrap32(rd()));
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
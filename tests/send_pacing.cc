@@ -0,0 +1,90 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = 1'000'000;  // one full segment per millisecond
+
+      TCPSenderTestHarness test{"Pacing at a configured rate", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 10000}});
+      test.execute(Push{string(5000, 'x')});
+      test.execute(ExpectNoSegment{});
+      test.execute(Tick{1});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1));
+      test.execute(ExpectNoSegment{});
+
+      // A coarser tick releases everything that fell due during it.
+      test.execute(Tick{3});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1001));
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 2001));
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 3001));
+      test.execute(ExpectNoSegment{});
+      test.execute(ExpectSeqnosInFlight{4000});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.congestion_control = CongestionControl::Algorithm::Reno;
+
+      TCPSenderTestHarness test{"Pacing at twice the congestion window per SRTT", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Tick{10});
+      test.execute(Receive{{isn + 1, UINT16_MAX}});
+      test.execute(ExpectCongestionWindow{10001});
+
+      // 2 * 10001 bytes per 10 ms: a segment about every 500 us
+      test.execute(Push{string(5000, 'x')});
+      test.execute(ExpectMessage{}.with_payload_size(1000));
+      test.execute(ExpectNoSegment{});
+      test.execute(Tick{1});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_payload_size(1000));
+      test.execute(ExpectMessage{}.with_payload_size(1000));
+      test.execute(ExpectNoSegment{});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test{"Without pacing, the window goes out at once", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Tick{10});
+      test.execute(Receive{{isn + 1, 10000}});
+      test.execute(Push{string(5000, 'x')});
+      test.execute(ExpectSeqnosInFlight{5000});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+#include "byte_stream.hh"
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Each SYN announces an MSS (0 for none), and the client sends segments as big as the smaller
+// of the two, taking TCPConfig::MAX_PAYLOAD_SIZE for a missing one.
+void negotiation_test(Wrap32 isn, uint16_t client_mss, uint16_t server_mss,
+                      size_t expected_payload) {
+  TCPConfig client_cfg;
+  client_cfg.fixed_isn = isn;
+  client_cfg.mss = client_mss;
+  TCPConfig server_cfg;
+  server_cfg.mss = server_mss;
+
+  TCPPeer client{client_cfg};
+  TCPPeer server{server_cfg};
+  vector<TCPSegment> to_server;
+  vector<TCPSegment> to_client;
+
+  client.outbound_writer().push(string(20'000, 'x'));
+  client.push();
+  exchange(client, server, to_server, to_client);
+  if (client_mss > 0) {
+    expect(to_server.front().mss == client_mss, "client's SYN did not announce its MSS");
+  } else {
+    expect(not to_server.front().mss.has_value(), "client announced an MSS it wasn't given");
+  }
+  if (server_mss > 0) {
+    expect(to_client.front().mss == server_mss, "server's SYN did not announce its MSS");
+  } else {
+    expect(not to_client.front().mss.has_value(), "server announced an MSS it wasn't given");
+  }
+
+  size_t largest = 0;
+  for (const auto &seg : to_server) {
+    largest = max(largest, seg.sender_message.payload.size());
+    expect(seg.sender_message.SYN or seg.mss == nullopt, "MSS option outside a SYN");
+  }
+  expect(largest == expected_payload, "largest segment was " + to_string(largest) + " bytes");
+  expect(client.sender().mss() == expected_payload, "sender's MSS not the negotiated one");
+  expect(server.inbound_reader().bytes_buffered() == 20'000, "server did not get the data");
+}
+
+// The congestion window counts segments of the MSS in use, not of the default one.
+void congestion_window_test(Wrap32 isn, CongestionControl::Algorithm algorithm) {
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.congestion_control = algorithm;
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+
+  expect(sender.congestion_window() == 10 * TCPConfig::MAX_PAYLOAD_SIZE, "wrong initial window");
+  sender.set_mss(1460);
+  expect(sender.congestion_window() == 14600, "initial window not ten 1460-byte segments");
+
+  sender.push(stream.reader());
+  expect(sender.maybe_send().has_value(), "no SYN");
+  sender.receive({isn + 1, UINT16_MAX});
+  stream.writer().push(string(5000, 'x'));
+  sender.push(stream.reader());
+  while (sender.maybe_send().has_value()) {}
+  sender.tick(cfg.rt_timeout);
+  expect(sender.congestion_window() == 1460, "loss window not one 1460-byte segment");
+}
+
+// A bulk transfer over a path that drops (rather than fragments) segments with more than
+// `path_mss` bytes of payload, which changes to `later_path_mss` halfway through. The sender is
+// told it may use up to `max_mss`; returns the MSS probing settled on. The path has no delay, so
+// a short RTO finds lost probes quickly.
+struct Path {
+  uint64_t path_mss;
+  uint64_t later_path_mss;
+  uint64_t max_mss;
+};
+
+uint64_t probing_test(Wrap32 isn, Path path, uint64_t duration_ms) {
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.rt_timeout = 50;
+  cfg.pmtu_probing = true;
+  cfg.send_capacity = 20'000;
+  cfg.recv_capacity = 20'000;
+  ByteStream outbound{cfg.send_capacity};
+  ByteStream inbound{cfg.recv_capacity};
+  TCPSender sender{cfg};
+  TCPReceiver receiver;
+  Reassembler reassembler;
+
+  // Byte i of the stream is i % 251: any stretch of it is a slice of `pattern`.
+  constexpr uint64_t PERIOD = 251;
+  string pattern(PERIOD + cfg.send_capacity, 0);
+  for (uint64_t i = 0; i < pattern.size(); i++) {
+    pattern[i] = static_cast<char>(i % PERIOD);
+  }
+
+  for (uint64_t now_ms = 0; now_ms < duration_ms; now_ms += 10) {
+    const uint64_t path_mss = now_ms < duration_ms / 2 ? path.path_mss : path.later_path_mss;
+    sender.tick(10);
+
+    Writer &writer = outbound.writer();
+    writer.push(pattern.substr(writer.bytes_pushed() % PERIOD, writer.available_capacity()));
+    sender.push(outbound.reader());
+
+    while (auto message = sender.maybe_send()) {
+      if (message->SYN) {
+        // The peer's SYN-ACK: the largest MSS it allows
+        receiver.receive(message.value(), reassembler, inbound.writer());
+        sender.receive(receiver.send(inbound.writer()));
+        sender.set_mss(path.max_mss);
+        continue;
+      }
+      if (message->payload.size() <= path_mss) {
+        receiver.receive(message.value(), reassembler, inbound.writer());
+        sender.receive(receiver.send(inbound.writer()));
+      }
+    }
+    sender.push(outbound.reader());
+
+    // Check what arrived, then make room for more.
+    Reader &reader = inbound.reader();
+    for (string_view chunk = reader.peek(); not chunk.empty(); chunk = reader.peek()) {
+      const string_view expected = string_view{pattern}.substr(reader.bytes_popped() % PERIOD);
+      expect(chunk == expected.substr(0, chunk.size()), "data corrupted");
+      reader.pop(chunk.size());
+    }
+  }
+  expect(inbound.reader().bytes_popped() > duration_ms * 100, "transfer stalled");
+  return sender.mss();
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPSegment seg;
+      seg.sender_message.SYN = true;
+      seg.mss = 1460;
+      seg.window_scale = 7;
+      seg.sack_permitted = true;
+      const TCPSegment parsed = over_the_wire(seg);
+      expect(parsed.mss == 1460 and parsed.window_scale == 7 and parsed.sack_permitted,
+             "SYN options did not survive the wire");
+    }
+
+    negotiation_test(Wrap32(rd()), 8960, 1460, 1460);
+    negotiation_test(Wrap32(rd()), 8960, 0, TCPConfig::MAX_PAYLOAD_SIZE);
+    negotiation_test(Wrap32(rd()), 0, 536, 536);
+    for (const auto algorithm :
+         {CongestionControl::Algorithm::Reno, CongestionControl::Algorithm::NewReno,
+          CongestionControl::Algorithm::Cubic, CongestionControl::Algorithm::BBR}) {
+      congestion_window_test(Wrap32(rd()), algorithm);
+    }
+
+    // The search finds the path's MSS, or the negotiated limit if the path allows more.
+    expect_between(probing_test(Wrap32(rd()), {4000, 4000, 8960}, 3'000), 4000 - 32, 4000,
+                   "MSS over a 4000-byte path");
+    expect_between(probing_test(Wrap32(rd()), {9000, 9000, 8960}, 3'000), 8960 - 32, 8960,
+                   "MSS up to the negotiated limit");
+
+    // A path whose MTU shrinks black-holes the bigger segments: the sender falls back, and
+    // searches again.
+    expect_between(probing_test(Wrap32(rd()), {8960, 1460, 8960}, 6'000), 1460 - 32, 1460,
+                   "MSS after the path changed");
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test{"RTO stays at its initial value by default", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Tick{100});
+      test.execute(Receive{{isn + 1, 1000}});
+      test.execute(ExpectSmoothedRTT{100});
+      test.execute(ExpectRTO{cfg.rt_timeout});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.rtt_estimation = true;
+
+      TCPSenderTestHarness test{"RTO follows SRTT and RTTVAR", cfg};
+      test.execute(ExpectRTO{1000});
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Tick{100});
+      test.execute(Receive{{isn + 1, 1000}});
+      // First sample: SRTT = 100, RTTVAR = 50
+      test.execute(ExpectSmoothedRTT{100});
+      test.execute(ExpectRTO{300});
+
+      test.execute(Push{"abc"});
+      test.execute(ExpectMessage{}.with_data("abc"));
+      test.execute(Tick{100});
+      test.execute(Receive{{isn + 4, 1000}});
+      // SRTT = 100, RTTVAR = 3/4 * 50
+      test.execute(ExpectSmoothedRTT{100});
+      test.execute(ExpectRTO{250});
+
+      test.execute(Push{"def"});
+      test.execute(ExpectMessage{}.with_data("def"));
+      test.execute(Tick{249});
+      test.execute(ExpectNoSegment{});
+      test.execute(Tick{1}.with_max_retx_exceeded(false));
+      test.execute(ExpectMessage{}.with_data("def"));
+      test.execute(ExpectRTO{500});
+
+      // Karn's algorithm: the ACK may be for either transmission, so it gives no sample.
+      test.execute(Tick{400});
+      test.execute(Receive{{isn + 7, 1000}});
+      test.execute(ExpectSmoothedRTT{100});
+      test.execute(ExpectRTO{250});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.rtt_estimation = true;
+      cfg.rt_timeout = 300;
+      cfg.rto_min_ms = 200;
+      cfg.rto_max_ms = 400;
+
+      TCPSenderTestHarness test{"RTO is clamped, including when backing off", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Tick{10});
+      test.execute(Receive{{isn + 1, 1000}});
+      test.execute(ExpectSmoothedRTT{10});
+      test.execute(ExpectRTO{200});
+
+      test.execute(Push{"x"});
+      test.execute(ExpectMessage{}.with_data("x"));
+      test.execute(Tick{200}.with_max_retx_exceeded(false));
+      test.execute(ExpectMessage{}.with_data("x"));
+      test.execute(ExpectRTO{400});
+      test.execute(Tick{400}.with_max_retx_exceeded(false));
+      test.execute(ExpectMessage{}.with_data("x"));
+      test.execute(ExpectRTO{400});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+TCPReceiverMessage sack(Wrap32 ackno, uint16_t window, const vector<pair<Wrap32, Wrap32>> &blocks) {
+  TCPReceiverMessage msg{ackno, window};
+  for (const auto &[left, right] : blocks) {
+    msg.sack_blocks.at(msg.num_sack_blocks++) = {left, right};
+  }
+  return msg;
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test{"SACK recovery skips received data and fills holes in order", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 20000}});
+      test.execute(Push{string(10000, 'x')});
+      for (uint32_t i = 0; i < 10; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+
+      // The second and fifth segments are lost.
+      test.execute(Receive{{isn + 1001, 20000}});
+      test.execute(Receive{sack(isn + 1001, 20000, {{isn + 2001, isn + 3001}})});
+      test.execute(Receive{sack(isn + 1001, 20000, {{isn + 2001, isn + 4001}})});
+      test.execute(ExpectNoSegment{});
+      test.execute(
+          Receive{sack(isn + 1001, 20000, {{isn + 5001, isn + 6001}, {isn + 2001, isn + 4001}})});
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1001));
+      test.execute(ExpectNoSegment{});
+
+      // The next duplicate ACK retransmits the next hole, skipping the SACKed segments.
+      test.execute(
+          Receive{sack(isn + 1001, 20000, {{isn + 5001, isn + 7001}, {isn + 2001, isn + 4001}})});
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 4001));
+      test.execute(
+          Receive{sack(isn + 1001, 20000, {{isn + 5001, isn + 8001}, {isn + 2001, isn + 4001}})});
+      test.execute(ExpectNoSegment{});
+
+      // The partial ACK finds the hole already retransmitted.
+      test.execute(Receive{sack(isn + 4001, 20000, {{isn + 5001, isn + 9001}})});
+      test.execute(ExpectNoSegment{});
+      test.execute(Receive{{isn + 10001, 20000}});
+      test.execute(ExpectSeqnosInFlight{0});
+      test.execute(ExpectNoSegment{});
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn(rd());
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test{"Stale and bogus SACK blocks are ignored", cfg};
+      test.execute(Push{});
+      test.execute(ExpectMessage{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+      test.execute(Receive{{isn + 1, 20000}});
+      test.execute(Push{string(5000, 'x')});
+      for (uint32_t i = 0; i < 5; i++) {
+        test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+      }
+      for (int i = 0; i < 3; i++) {
+        test.execute(Receive{sack(isn + 1, 20000, {{isn + 9001, isn + 9501}, {isn, isn + 1}})});
+      }
+      test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1));
+
+      // With nothing SACKed above them, later segments aren't presumed lost.
+      test.execute(Receive{sack(isn + 1, 20000, {{isn + 9001, isn + 9501}})});
+      test.execute(ExpectNoSegment{});
+      test.execute(Receive{{isn + 5001, 20000}});
+      test.execute(ExpectSeqnosInFlight{0});
+    }
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
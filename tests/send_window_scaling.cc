@@ -0,0 +1,91 @@
+#include "peer_test_helpers.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void scaling_test(Wrap32 isn, bool receiver_scales) {
+  TCPConfig client_cfg;
+  client_cfg.fixed_isn = isn;
+  client_cfg.window_scaling = true;
+  client_cfg.send_capacity = 4'000'000;
+
+  TCPConfig server_cfg;
+  server_cfg.recv_capacity = 4'000'000;
+  server_cfg.window_scaling = receiver_scales;
+
+  TCPPeer client{client_cfg};
+  TCPPeer server{server_cfg};
+  vector<TCPSegment> to_server;
+  vector<TCPSegment> to_client;
+
+  client.push();
+  exchange(client, server, to_server, to_client);
+  expect(to_server.size() >= 2 and to_client.size() >= 1, "handshake did not complete");
+  expect(to_server.front().window_scale == 0, "a 64 KB buffer needs no shift (but offers it)");
+  const auto &syn_ack = to_client.front();
+  expect(syn_ack.sender_message.SYN, "server did not answer with a SYN");
+  expect(syn_ack.receiver_message.window_size == UINT16_MAX, "SYN windows are never scaled");
+  if (receiver_scales) {
+    expect(syn_ack.window_scale == 6, "4 MB needs a shift of 6");
+  } else {
+    expect(not syn_ack.window_scale.has_value(), "server offered scaling when it wasn't on");
+  }
+
+  // The SYN's window limits the first flight either way.
+  client.outbound_writer().push(string(1'000'000, 'x'));
+  client.push();
+  expect(client.sender().sequence_numbers_in_flight() == UINT16_MAX, "first flight too big");
+
+  // After one round trip, the server's ACKs carry its real window: with scaling, the client
+  // may have far more than 64 KB in flight.
+  to_server.clear();
+  to_client.clear();
+  round_trip(client, server, to_server, to_client);
+  client.push();
+  const uint64_t in_flight = client.sender().sequence_numbers_in_flight();
+  if (receiver_scales) {
+    expect(in_flight == 1'000'000 - UINT16_MAX, "client sent only " + to_string(in_flight));
+  } else {
+    expect(in_flight == UINT16_MAX, "client sent " + to_string(in_flight) + " bytes");
+  }
+
+  // Deliver it all: the scaled windows on the wire still describe the server's buffer.
+  to_server.clear();
+  to_client.clear();
+  exchange(client, server, to_server, to_client);
+  expect(client.sender().sequence_numbers_in_flight() == 0, "data not all acknowledged");
+  const auto &last_ack = to_client.back().receiver_message;
+  if (receiver_scales) {
+    expect(last_ack.window_size == (4'000'000 - 1'000'000) >> 6, "wire window not scaled");
+  }
+  expect(server.inbound_reader().bytes_buffered() == 1'000'000, "server did not get the data");
+}
+
+}  // namespace
+
+int main() {
+  try {
+    auto rd = get_random_engine();
+
+    scaling_test(Wrap32(rd()), true);
+    scaling_test(Wrap32(rd()), false);
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "byte_stream.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// Send `chunks` 64 KiB chunks through a TCPSender in segments of `mss` bytes, to a synthetic
+// receiver that acknowledges each segment as soon as it is sent, and report segments sent per
+// second. Every `loss_interval`th new segment (0 for none) is dropped, for fast retransmit to
+// repair: the window never holds two of them, so the receiver only needs to remember one hole.
+void speed_test(const string &name, uint64_t mss, uint64_t chunks, uint64_t loss_interval) {
+  const Wrap32 isn{0x9abcdef0};
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.fast_retransmit = true;
+  cfg.send_capacity = 1 << 20;
+  ByteStream stream{cfg.send_capacity};
+  TCPSender sender{cfg};
+  sender.set_mss(mss);
+
+  const Buffer chunk{string(1 << 16, 'x')};
+  const uint64_t total = chunks * chunk.size();
+  uint64_t written = 0;
+
+  uint64_t expected = 0;  // The receiver's ackno, as an absolute sequence number
+  uint64_t highest = 0;   // The end of the highest segment it has received
+  uint64_t new_segments = 0;
+  uint64_t segments = 0;
+
+  const auto start_time = steady_clock::now();
+  while (expected < total + 1) {
+    sender.tick(1);
+    while (written < total and stream.writer().available_capacity() >= chunk.size()) {
+      stream.writer().push(chunk);
+      written += chunk.size();
+    }
+    sender.push(stream.reader());
+
+    while (auto message = sender.maybe_send()) {
+      segments++;
+      const uint64_t seqno = message->seqno.unwrap(isn, expected);
+      const uint64_t end = seqno + message->sequence_length();
+      if (end > highest and loss_interval > 0 and ++new_segments % loss_interval == 0) {
+        continue;
+      }
+      if (seqno <= expected) {
+        expected = max(expected, max(end, highest));
+      }
+      highest = max(highest, end);
+      sender.receive({Wrap32::wrap(expected, isn), UINT16_MAX});
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if (sender.sequence_numbers_in_flight() != 0 or stream.reader().bytes_popped() != total) {
+    throw runtime_error("TCPSender did not deliver every byte");
+  }
+
+  auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+  auto segments_per_second = static_cast<double>(segments) / test_duration.count();
+  auto gigabits_per_second = 8 * static_cast<double>(total) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  cout << "TCPSender with " << name << " reached " << fixed << setprecision(2)
+       << segments_per_second / 1e6 << " million segments/s (" << gigabits_per_second
+       << " Gbit/s).\n";
+
+  debug_output << "  " << setw(28) << name << ": " << fixed << setprecision(2)
+               << segments_per_second / 1e6 << " million segments/s\n";
+
+  if (segments_per_second < 1e5) {
+    throw runtime_error("TCPSender with " + name +
+                        " did not meet minimum speed of 0.1 million segments/s.");
+  }
+}
+
+void program_body() {
+  speed_test("1000-byte segments", 1000, 1 << 14, 0);
+  speed_test("100-byte segments", 100, 1 << 11, 0);
+  speed_test("1000-byte segments, 0.1% loss", 1000, 1 << 14, 1000);
+}
+
+}  // namespace
+
+int main() {
+  try {
+    program_body();
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -52,6 +52,26 @@ struct ExpectSeqnosInFlight : public ExpectNumber<StreamAndSender, uint64_t> {
   }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<StreamAndSender, uint64_t> {
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value(StreamAndSender &ss) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectRTO : public ExpectNumber<StreamAndSender, uint64_t> {
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTO_ms"; }
+  uint64_t value(StreamAndSender &ss) const override { return ss.second.RTO_ms(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<StreamAndSender, uint64_t> {
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "smoothed_RTT_ms (0 if none)"; }
+  uint64_t value(StreamAndSender &ss) const override {
+    return ss.second.smoothed_RTT_ms().value_or(0);
+  }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender> {
   std::string description() const override { return "nothing to send"; }
   void execute(StreamAndSender &ss) const override {
@@ -282,5 +302,5 @@ class TCPSenderTestHarness : public TestHarness<StreamAndSender> {
   TCPSenderTestHarness(std::string name, TCPConfig config)
       : TestHarness(
             move(name), "initial_RTO_ms=" + to_string(config.rt_timeout),
-            {ByteStream{config.send_capacity}, TCPSender{config.rt_timeout, config.fixed_isn}}) {}
+            {ByteStream{config.send_capacity}, TCPSender{config}}) {}
 };
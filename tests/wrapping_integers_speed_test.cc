@@ -0,0 +1,122 @@
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// The out-of-line, branching unwrap this library used to have, as a baseline
+[[gnu::noinline]] uint64_t reference_unwrap(uint32_t raw_value, uint32_t zero_point,
+                                            uint64_t checkpoint) {
+  constexpr uint64_t span = uint64_t{1} << 32;
+  const uint64_t offset = static_cast<uint32_t>(raw_value - zero_point);
+  const uint64_t candidate = (checkpoint & ~(span - 1)) | offset;
+  if (candidate > checkpoint and candidate >= span and candidate - checkpoint > span / 2) {
+    return candidate - span;
+  }
+  if (candidate < checkpoint and candidate < UINT64_MAX - span and
+      checkpoint - candidate > span / 2) {
+    return candidate + span;
+  }
+  return candidate;
+}
+
+// Unwrap `rounds` times over a set of sequence numbers scattered around successive checkpoints,
+// as a receiver or sender would see them, and report unwraps per second.
+void speed_test(const string &name, const size_t rounds,
+                const function<void(span<const Wrap32>, span<const uint32_t>, Wrap32, uint64_t,
+                                    span<uint64_t>)> &unwrap_all) {
+  constexpr size_t count = 4096;
+  constexpr uint32_t isn = 0x9abcdef0;
+  default_random_engine rd{1370};  // NOLINT(cert-msc32-c, cert-msc51-cpp)
+  uniform_int_distribution<uint32_t> near{0, 1 << 20};
+
+  vector<uint32_t> raw(count);
+  vector<Wrap32> seqnos;
+  for (auto &r : raw) {
+    r = isn + near(rd);
+    seqnos.emplace_back(r);
+  }
+  vector<uint64_t> out(count);
+
+  uint64_t checksum = 0;
+  const auto start_time = steady_clock::now();
+  for (size_t i = 0; i < rounds; i++) {
+    const uint64_t checkpoint = i * 0x10000000;  // wraps every 16 rounds
+    unwrap_all(seqnos, raw, Wrap32{isn}, checkpoint, out);
+    checksum += out[i % count];
+  }
+  const auto stop_time = steady_clock::now();
+
+  // Check the results of the last round against the baseline.
+  const uint64_t checkpoint = (rounds - 1) * 0x10000000;
+  for (size_t i = 0; i < count; i++) {
+    if (out[i] != reference_unwrap(raw[i], isn, checkpoint)) {
+      throw runtime_error(name + " disagrees with the reference unwrap");
+    }
+  }
+
+  auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+  auto unwraps_per_second = static_cast<double>(rounds * count) / test_duration.count();
+
+  fstream debug_output;
+  debug_output.open("/dev/tty");
+
+  cout << "Wrap32 " << name << " reached " << fixed << setprecision(0) << unwraps_per_second / 1e6
+       << " million unwraps/s (checksum " << checksum % 1000 << ").\n";
+
+  debug_output << "  " << setw(24) << name << ": " << fixed << setprecision(0)
+               << unwraps_per_second / 1e6 << " million unwraps/s\n";
+
+  if (unwraps_per_second < 1e7) {
+    throw runtime_error("Wrap32 " + name + " did not meet minimum speed of 10 million unwraps/s.");
+  }
+}
+
+void program_body() {
+  constexpr size_t rounds = 20000;
+
+  speed_test("reference unwrap", rounds,
+             [](auto, span<const uint32_t> raw, Wrap32, uint64_t checkpoint, span<uint64_t> out) {
+               for (size_t i = 0; i < raw.size(); i++) {
+                 out[i] = reference_unwrap(raw[i], 0x9abcdef0, checkpoint);
+               }
+             });
+
+  speed_test("inline unwrap", rounds,
+             [](span<const Wrap32> seqnos, auto, Wrap32 zero_point, uint64_t checkpoint,
+                span<uint64_t> out) {
+               for (size_t i = 0; i < seqnos.size(); i++) {
+                 out[i] = seqnos[i].unwrap(zero_point, checkpoint);
+               }
+             });
+
+  speed_test("unwrap_many", rounds,
+             [](span<const Wrap32> seqnos, auto, Wrap32 zero_point, uint64_t checkpoint,
+                span<uint64_t> out) { Wrap32::unwrap_many(seqnos, zero_point, checkpoint, out); });
+}
+
+}  // namespace
+
+int main() {
+  try {
+    program_body();
+  } catch (const exception &e) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
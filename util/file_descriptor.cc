@@ -8,7 +8,9 @@
 #include <sys/uio.h>
 #include <unistd.h>
 #include <algorithm>
+#include <climits>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 
 using namespace std;
@@ -152,10 +154,12 @@ size_t FileDescriptor::write(const vector<Buffer> &buffers) {
 }
 
 size_t FileDescriptor::write(const vector<string_view> &buffers) {
+  // writev accepts at most IOV_MAX buffers; anything past that is left for a later (partial) write
+  const size_t count = min(buffers.size(), static_cast<size_t>(IOV_MAX));
   vector<iovec> iovecs;
-  iovecs.reserve(buffers.size());
+  iovecs.reserve(count);
   size_t total_size = 0;
-  for (const auto x : buffers) {
+  for (const auto x : span{buffers}.first(count)) {
     iovecs.push_back({const_cast<char *>(x.data()), x.size()});  // NOLINT(*-const-cast)
     total_size += x.size();
   }
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A FIFO queue in one power-of-two array of slots, indexed from the front. Unlike std::deque, it
+// allocates only when it grows past its largest size so far, so a queue that fills and drains
+// over and over settles into a fixed ring. Elements can also be inserted in the middle (moving
+// the shorter side over by one), for the rare insertion into an otherwise ordered queue.
+template <typename T>
+class RingBuffer {
+  std::vector<std::optional<T>> slots_{};  // size is zero or a power of two
+  size_t head_{};                          // slot of the front element
+  size_t size_{};
+
+  std::optional<T> &slot(size_t index) { return slots_[(head_ + index) & (slots_.size() - 1)]; }
+  const std::optional<T> &slot(size_t index) const {
+    return slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+
+  // Double the capacity, unwrapping the elements to start at slot 0
+  void grow() {
+    std::vector<std::optional<T>> slots(slots_.empty() ? 16 : 2 * slots_.size());
+    for (size_t i = 0; i < size_; i++) {
+      slots[i] = std::move(slot(i));
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+ public:
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T &operator[](size_t index) { return *slot(index); }
+  const T &operator[](size_t index) const { return *slot(index); }
+  T &front() { return *slot(0); }
+  const T &front() const { return *slot(0); }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args) {
+    if (size_ == slots_.size()) {
+      grow();
+    }
+    return slot(size_++).emplace(std::forward<Args>(args)...);
+  }
+
+  void pop_front() {
+    if (empty()) {
+      throw std::runtime_error("RingBuffer::pop_front() on empty ring");
+    }
+    slot(0).reset();
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    size_--;
+  }
+
+  // Insert `value` so that it becomes the element at `index`
+  void insert(size_t index, T value) {
+    if (index > size_) {
+      throw std::out_of_range("RingBuffer::insert() past the end");
+    }
+    if (size_ == slots_.size()) {
+      grow();
+    }
+    if (index < size_ / 2) {
+      head_ = (head_ - 1) & (slots_.size() - 1);
+      for (size_t i = 0; i < index; i++) {
+        slot(i) = std::move(slot(i + 1));
+      }
+    } else {
+      for (size_t i = size_; i > index; i--) {
+        slot(i) = std::move(slot(i - 1));
+      }
+    }
+    slot(index) = std::move(value);
+    size_++;
+  }
+};
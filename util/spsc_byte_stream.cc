@@ -0,0 +1,136 @@
+#include "spsc_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <sys/eventfd.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream(uint64_t capacity)
+    : ring_(),
+      mask_(),
+      capacity_(capacity),
+      data_event_(CheckSystemCall("eventfd", ::eventfd(0, EFD_CLOEXEC))),
+      capacity_event_(CheckSystemCall("eventfd", ::eventfd(0, EFD_CLOEXEC))) {
+  if (capacity_ > (uint64_t{1} << 62)) {
+    throw runtime_error("SPSCByteStream capacity too large");
+  }
+  ring_.resize(bit_ceil(max(capacity_, uint64_t{1})));
+  mask_ = ring_.size() - 1;
+}
+
+// Announce that this side will sleep until signalled, unless the stream is `ready` after all:
+// checking after the announcement means progress the other side made meanwhile isn't missed.
+// Returns whether to sleep.
+bool SPSCByteStream::arm(atomic<bool> &waiting, bool (SPSCByteStream::*ready)() const) {
+  waiting.store(true, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in wake()
+  if ((this->*ready)()) {
+    waiting.store(false, memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+// After making progress: signal the other side, if it announced that it is sleeping.
+void SPSCByteStream::wake(atomic<bool> &waiting, FileDescriptor &event) {
+  atomic_thread_fence(memory_order_seq_cst);  // Publish the progress before reading the flag
+  if (waiting.load(memory_order_relaxed) and waiting.exchange(false, memory_order_relaxed)) {
+    const uint64_t one = 1;
+    event.write(string_view{reinterpret_cast<const char *>(&one), sizeof(one)});
+  }
+}
+
+void SPSCByteStream::clear(FileDescriptor &event) {
+  string count(sizeof(uint64_t), 0);
+  event.read(count);
+}
+
+bool SPSCByteStream::data_ready() const {
+  return bytes_buffered() > 0 or closed_.load(memory_order_acquire) or has_error();
+}
+
+bool SPSCByteStream::capacity_ready() const { return available_capacity() > 0 or has_error(); }
+
+uint64_t SPSCByteStream::push(string_view data) {
+  const uint64_t pushed = pushed_.load(memory_order_relaxed);
+  const uint64_t room = capacity_ - (pushed - popped_.load(memory_order_acquire));
+  const uint64_t len = min(room, static_cast<uint64_t>(data.size()));
+  if (len == 0) {
+    return 0;
+  }
+
+  // Copy into the ring, wrapping around its end at most once, then publish the bytes.
+  const uint64_t start = pushed & mask_;
+  const uint64_t first = min(len, ring_.size() - start);
+  memcpy(ring_.data() + start, data.data(), first);
+  memcpy(ring_.data(), data.data() + first, len - first);
+  pushed_.store(pushed + len, memory_order_release);
+
+  wake(reader_waiting_, data_event_);
+  return len;
+}
+
+void SPSCByteStream::close() {
+  closed_.store(true, memory_order_release);
+  wake(reader_waiting_, data_event_);
+}
+
+void SPSCByteStream::set_error() {
+  error_.store(true, memory_order_release);
+  wake(reader_waiting_, data_event_);
+  wake(writer_waiting_, capacity_event_);
+}
+
+void SPSCByteStream::wait_for_capacity() {
+  while (arm_capacity_event()) {
+    clear_capacity_event();
+  }
+}
+
+uint64_t SPSCByteStream::available_capacity() const { return capacity_ - bytes_buffered(); }
+
+uint64_t SPSCByteStream::bytes_pushed() const { return pushed_.load(memory_order_acquire); }
+
+string_view SPSCByteStream::peek() const {
+  const uint64_t popped = popped_.load(memory_order_relaxed);
+  const uint64_t buffered = pushed_.load(memory_order_acquire) - popped;
+  const uint64_t start = popped & mask_;
+  return {ring_.data() + start, min(buffered, ring_.size() - start)};
+}
+
+void SPSCByteStream::pop(uint64_t len) {
+  const uint64_t popped = popped_.load(memory_order_relaxed);
+  const uint64_t buffered = pushed_.load(memory_order_acquire) - popped;
+  len = min(len, buffered);
+  if (len == 0) {
+    return;
+  }
+  popped_.store(popped + len, memory_order_release);
+  wake(writer_waiting_, capacity_event_);
+}
+
+void SPSCByteStream::wait_for_data() {
+  while (arm_data_event()) {
+    clear_data_event();
+  }
+}
+
+bool SPSCByteStream::is_finished() const {
+  // Check `closed` first: once it is set, no more bytes can arrive.
+  return closed_.load(memory_order_acquire) and bytes_buffered() == 0;
+}
+
+bool SPSCByteStream::has_error() const { return error_.load(memory_order_acquire); }
+
+uint64_t SPSCByteStream::bytes_buffered() const {
+  const uint64_t popped = popped_.load(memory_order_acquire);
+  return pushed_.load(memory_order_acquire) - popped;
+}
+
+uint64_t SPSCByteStream::bytes_popped() const { return popped_.load(memory_order_acquire); }
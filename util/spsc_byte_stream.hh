@@ -0,0 +1,82 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// A ByteStream for handing bytes from one thread to another without a kernel round trip.
+//
+// Exactly one thread may act as the writer (push/close/set_error/wait_for_capacity) and
+// exactly one thread as the reader (peek/pop/wait_for_data). The bytes live in a power-of-two
+// ring; the writer owns the `pushed` counter and the reader owns the `popped` counter, so no
+// locks are needed.
+//
+// A side that has to wait sleeps on an eventfd, which the other side writes only if it was told
+// (by a flag) that someone is sleeping, so a stream that never blocks makes no system calls. A
+// thread that sleeps in poll() rather than in wait_for_data()/wait_for_capacity(), such as one
+// running an EventLoop, can watch the same eventfds: arm the event, and if that says to wait,
+// poll its file descriptor, then clear it once it is readable.
+class SPSCByteStream {
+  std::vector<char> ring_;
+  uint64_t mask_;
+  uint64_t capacity_;
+
+  // Each counter gets its own cache line so the two threads do not false-share.
+  alignas(64) std::atomic<uint64_t> pushed_{0};  // written by the writer only
+  alignas(64) std::atomic<uint64_t> popped_{0};  // written by the reader only
+
+  // Set by a side about to sleep; the other side clears it and signals the eventfd
+  alignas(64) std::atomic<bool> reader_waiting_{false};
+  alignas(64) std::atomic<bool> writer_waiting_{false};
+  FileDescriptor data_event_;      // Signalled for a waiting reader
+  FileDescriptor capacity_event_;  // Signalled for a waiting writer
+
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> error_{false};
+
+  bool data_ready() const;
+  bool capacity_ready() const;
+  bool arm(std::atomic<bool> &waiting, bool (SPSCByteStream::*ready)() const);
+  static void wake(std::atomic<bool> &waiting, FileDescriptor &event);
+  static void clear(FileDescriptor &event);
+
+ public:
+  explicit SPSCByteStream(uint64_t capacity);
+
+  // Writer side
+  uint64_t push(std::string_view data);  // Push as much as fits; returns # of bytes pushed
+  void close();                          // Nothing more will be pushed
+  void set_error();                      // Signal that the stream suffered an error
+  void wait_for_capacity();              // Block until there is room (or the stream has an error)
+  uint64_t available_capacity() const;
+  uint64_t bytes_pushed() const;
+
+  // Reader side
+  std::string_view peek() const;  // Largest contiguous span of buffered bytes
+  void pop(uint64_t len);         // Remove up to `len` bytes
+  void wait_for_data();           // Block until bytes are buffered, or the stream ends or errors
+  bool is_finished() const;       // Closed and fully popped?
+  bool has_error() const;
+  uint64_t bytes_buffered() const;
+  uint64_t bytes_popped() const;
+
+  // For a side that waits in poll(): arm_*() returns whether to wait, that is, unless the stream
+  // is already ready, the other side's next progress makes the event's file descriptor readable.
+  // clear_*() consumes the signal (blocking until there is one).
+  bool arm_data_event() { return arm(reader_waiting_, &SPSCByteStream::data_ready); }
+  bool arm_capacity_event() { return arm(writer_waiting_, &SPSCByteStream::capacity_ready); }
+  FileDescriptor &data_event() { return data_event_; }
+  FileDescriptor &capacity_event() { return capacity_event_; }
+  void clear_data_event() { clear(data_event_); }
+  void clear_capacity_event() { clear(capacity_event_); }
+
+  // The atomics pin the stream in place
+  SPSCByteStream(const SPSCByteStream &other) = delete;
+  SPSCByteStream &operator=(const SPSCByteStream &other) = delete;
+  SPSCByteStream(SPSCByteStream &&other) = delete;
+  SPSCByteStream &operator=(SPSCByteStream &&other) = delete;
+  ~SPSCByteStream() = default;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -12,14 +13,33 @@ class TCPConfig {
   static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
   static constexpr size_t MAX_PAYLOAD_SIZE =
       1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_SUPER_SEGMENT_SIZE =
+      64000;  //!< Max super-segment payload, with large_send (in whole MSSes)
   static constexpr uint16_t TIMEOUT_DFLT = 1000;  //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS =
       8;  //!< Maximum re-transmit attempts before giving up
 
   uint16_t rt_timeout =
       TIMEOUT_DFLT;  //!< Initial value of the retransmission timeout, in milliseconds
+  bool rtt_estimation = false;  //!< Adapt the retransmission timeout to measured RTT (RFC 6298)
+  uint64_t rto_min_ms = 200;    //!< Lower bound on the adaptive retransmission timeout
+  uint64_t rto_max_ms = 60000;  //!< Upper bound on the adaptive (and backed-off) timeout
   size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
+  size_t recv_capacity_max = 0;  //!< Autotuning may grow the receive capacity up to this (0 = off)
+  uint64_t recv_autotune_interval_ms =
+      100;  //!< Autotuning's sampling interval until there is an RTT to sample over (0 = off)
   size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
+  CongestionControl::Algorithm congestion_control =
+      CongestionControl::Algorithm::None;  //!< Congestion control for the sender (None = off)
+  bool fast_retransmit = false;  //!< Retransmit on three duplicate ACKs, not just on timeouts
+  bool sack = false;             //!< Exchange SACK blocks (RFC 2018), if the peer agrees
+  bool window_scaling = false;   //!< Windows over 64 KB (RFC 7323), if the peer agrees
+  bool large_send = false;       //!< Send super-segments, for the adapter to split by MSS
+  uint16_t mss = 0;              //!< MSS to announce on the SYN: the MTU - 40 (0 = don't)
+  bool pmtu_probing = false;     //!< Search for the largest MSS the path carries (RFC 4821)
+  bool pacing = false;           //!< Spread segments out over the RTT instead of sending bursts
+  uint64_t pacing_rate = 0;      //!< Pacing rate, in bytes/second (0 = from congestion control)
+  uint64_t delayed_ack_ms = 0;   //!< Delay ACKs up to this long, ACKing every 2nd segment (0 = off)
   std::optional<Wrap32> fixed_isn{};
 };
 
@@ -9,16 +9,19 @@
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <utility>
 
 using namespace std;
 
-static constexpr size_t TCP_TICK_MS = 10;
+// The longest the TCPPeer thread sleeps without an event or timeout, so that it notices _abort
+static constexpr uint64_t TCP_MAX_WAIT_MS = 100;
 
 static inline uint64_t timestamp_ms() {
   static_assert(std::is_same<std::chrono::steady_clock::duration, std::chrono::nanoseconds>::value);
@@ -26,26 +29,41 @@ static inline uint64_t timestamp_ms() {
   return std::chrono::steady_clock::now().time_since_epoch().count() / 1000000;
 }
 
+template <typename AdaptT>
+void TCPMinnowSocket<AdaptT>::_tick() {
+  const auto now = timestamp_ms();
+  if (_tcp.value().active()) {
+    _tcp.value().tick(now - _last_tick_ms);
+    collect_segments();
+    _datagram_adapter.tick(now - _last_tick_ms);
+  }
+  _last_tick_ms = now;
+}
+
 //! \param[in] condition is a function returning true if loop should continue
+//! \details Rather than waking every few milliseconds to tick the TCPPeer, the loop sleeps until
+//! the TCPPeer's next timeout or the next event. The rules that hand the TCPPeer a segment or
+//! data tick it first, so that it sees the time they arrived.
 template <typename AdaptT>
 void TCPMinnowSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
-  auto base_time = timestamp_ms();
+  if (not _tcp.has_value()) {
+    throw runtime_error("_tcp_loop entered before TCPPeer initialized");
+  }
+
+  _last_tick_ms = timestamp_ms();
   while (condition()) {
-    auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+    const optional<uint64_t> timeout =
+        _tcp.value().active() ? _tcp.value().next_timeout_ms() : nullopt;
+    const uint64_t due = timeout.has_value() ? _last_tick_ms + timeout.value() : UINT64_MAX;
+    const auto now = timestamp_ms();
+    const uint64_t wait_ms = min(due - min(due, now), TCP_MAX_WAIT_MS);
+
+    auto ret = _eventloop.wait_next_event(static_cast<int>(wait_ms));
     if (ret == EventLoop::Result::Exit or _abort) {
       break;
     }
-
-    if (not _tcp.has_value()) {
-      throw runtime_error("_tcp_loop entered before TCPPeer initialized");
-    }
-
-    if (_tcp.value().active()) {
-      const auto next_time = timestamp_ms();
-      _tcp.value().tick(next_time - base_time);
-      collect_segments();
-      _datagram_adapter.tick(next_time - base_time);
-      base_time = next_time;
+    if (timestamp_ms() >= due) {
+      _tick();
     }
   }
 }
@@ -66,6 +84,11 @@ template <typename AdaptT>
 void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
   _tcp.emplace(config);
 
+  // The streams say when rules 2 and 3 have work, so their interest needn't query the streams
+  // on every trip around the loop.
+  _tcp->inbound_reader().on_readable([this] { _inbound_readable = true; });
+  _tcp->outbound_writer().on_writable([this] { _outbound_writable = true; });
+
   // Set up the event loop
 
   // There are four possible events to handle:
@@ -88,6 +111,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
   _eventloop.add_rule(
       "receive TCP segment from the network", _datagram_adapter.fd(), Direction::In,
       [&] {
+        _tick();
         if (auto seg = _datagram_adapter.read()) {
           _tcp->receive(move(seg.value()));
           collect_segments();
@@ -107,10 +131,12 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
   _eventloop.add_rule(
       "push bytes to TCPPeer", _thread_data, Direction::In,
       [&] {
+        _tick();
         string data;
         data.resize(_tcp->outbound_writer().available_capacity());
         _thread_data.read(data);
         _tcp->outbound_writer().push(move(data));
+        _outbound_writable = _tcp->outbound_writer().available_capacity() > 0;
 
         if (_thread_data.eof()) {
           _tcp->outbound_writer().close();
@@ -126,10 +152,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _tcp->push();
         collect_segments();
       },
-      [&] {
-        return (_tcp->active()) and (not _outbound_shutdown) and
-               (_tcp->outbound_writer().available_capacity() > 0);
-      },
+      [&] { return _outbound_writable and not _outbound_shutdown and _tcp->active(); },
       [&] {
         _tcp->outbound_writer().close();
         _outbound_shutdown = true;
@@ -144,8 +167,8 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         // the pipe, handling the possibility of a partial
         // write (i.e., only pop what was actually written).
         if (inbound.bytes_buffered()) {
-          const std::string_view buffer = inbound.peek();
-          const auto bytes_written = _thread_data.write(buffer);
+          inbound.peek_all(_inbound_views);
+          const auto bytes_written = _thread_data.write(_inbound_views);
           inbound.pop(bytes_written);
         }
 
@@ -158,12 +181,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
                << _datagram_adapter.config().destination.to_string() << " finished "
                << (inbound.has_error() ? "with an error/reset.\n" : "cleanly.\n");
         }
+        _inbound_readable = inbound.bytes_buffered() > 0 and not _inbound_shutdown;
       },
-      [&] {
-        return _tcp->inbound_reader().bytes_buffered() or
-               ((_tcp->inbound_reader().is_finished() or _tcp->inbound_reader().has_error()) and
-                not _inbound_shutdown);
-      });
+      [&] { return _inbound_readable; });
 
   // rule 4: read outbound segments from TCPConnection and send as datagrams
   _eventloop.add_rule(
@@ -36,10 +36,19 @@ class TCPMinnowSocket : public LocalStreamSocket {
   //! Segments queued to be sent on the network
   std::queue<TCPSegment> outgoing_segments_{};
 
+  //! Scratch list of buffered inbound spans, reused for each write to the owner
+  std::vector<std::string_view> _inbound_views{};
+
   //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound
   //! bytes)
   EventLoop _eventloop{};
 
+  //! When the TCPPeer and the adapter were last ticked
+  uint64_t _last_tick_ms{};
+
+  //! Tick the TCPPeer and the adapter up to the present
+  void _tick();
+
   //! Process events while specified condition is true
   void _tcp_loop(const std::function<bool()> &condition);
 
@@ -63,6 +72,12 @@ class TCPMinnowSocket : public LocalStreamSocket {
 
   bool _fully_acked{false};  //!< Has the outbound data been fully acknowledged by the peer?
 
+  //! Set by the inbound stream's on_readable callback; cleared once the owner has everything
+  bool _inbound_readable{false};
+
+  //! Cleared when the outbound stream fills; set by its on_writable callback once it drains
+  bool _outbound_writable{true};
+
   void collect_segments();  //!< Drain segments from the TCPPeer
 
  public:
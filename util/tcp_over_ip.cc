@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -72,24 +73,45 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDatagram
   return tcp_seg;
 }
 
-//! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
+//! Takes a TCP segment, sets port numbers as necessary, and wraps it in IPv4 datagrams: just one,
+//! unless it is a super-segment (with more than its `segment_size` bytes of payload, from a sender
+//! using TCPConfig::large_send), which is split into segments of that size first.
 //! \param[in] seg is the TCP segment to convert
-InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
+vector<InternetDatagram> TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
   // set the port numbers in the TCP segment
   seg.udinfo.src_port = config().source.port();
   seg.udinfo.dst_port = config().destination.port();
 
-  // create an Internet Datagram and set its addresses and length
+  // create an Internet Datagram and set its addresses (the length is set per segment)
   InternetDatagram ip_dgram;
   ip_dgram.header.src = config().source.ipv4_numeric();
   ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len =
-      ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.sender_message.payload.size();
+  ip_dgram.header.df = true;  // Path MTU discovery: a datagram too big is dropped, not fragmented
 
-  // set payload, calculating TCP checksum using information from IP header
-  seg.compute_checksum(ip_dgram.header.pseudo_checksum());
-  ip_dgram.header.compute_checksum();
-  ip_dgram.payload = serialize(seg);
+  auto wrap = [&ip_dgram](const TCPSegment &tcp_seg) {
+    ip_dgram.header.len = ip_dgram.header.hlen * 4 + tcp_seg.header_length() +
+                          tcp_seg.sender_message.payload.size();
+    ip_dgram.header.compute_checksum();
+    ip_dgram.payload = serialize(tcp_seg);
+    return ip_dgram;
+  };
 
-  return ip_dgram;
+  const size_t segment_size = seg.segment_size > 0 ? seg.segment_size : TCPConfig::MAX_PAYLOAD_SIZE;
+  if (seg.sender_message.payload.size() <= segment_size) {
+    // set payload, calculating TCP checksum using information from IP header
+    ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() +
+                          seg.sender_message.payload.size();
+    seg.compute_checksum(ip_dgram.header.pseudo_checksum());
+    return {wrap(seg)};
+  }
+
+  // The pseudo-header's checksum without the TCP length, which split() adds for each segment
+  ip_dgram.header.len = ip_dgram.header.hlen * 4;
+  const uint32_t pseudo_checksum = ip_dgram.header.pseudo_checksum();
+
+  vector<InternetDatagram> datagrams;
+  for (const auto &tcp_seg : seg.split(segment_size, pseudo_checksum)) {
+    datagrams.push_back(wrap(tcp_seg));
+  }
+  return datagrams;
 }
@@ -7,17 +7,76 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <optional>
 
 class TCPPeer {
   TCPConfig cfg_;
-  TCPSender sender_{cfg_.rt_timeout, cfg_.fixed_isn};
+  TCPSender sender_{cfg_};
   TCPReceiver receiver_{};
   Reassembler reassembler_{};
 
   ByteStream outbound_stream_{cfg_.send_capacity}, inbound_stream_{cfg_.recv_capacity};
 
   bool need_send_{};
+  bool peer_sack_permitted_{};  // The peer's SYN had the SACK-permitted option
+
+  // RFC 7323 window scaling: the shift our SYN offers (enough for the largest receive capacity),
+  // and the peer's. Once both SYNs have offered it, windows on the wire are scaled down by the
+  // sender's shift, except in the SYNs themselves.
+  uint8_t window_shift_{window_shift_for(std::max(cfg_.recv_capacity, cfg_.recv_capacity_max))};
+  std::optional<uint8_t> peer_window_shift_{};
+
+  static uint8_t window_shift_for(uint64_t capacity) {
+    uint8_t shift = 0;
+    while ((capacity >> shift) > UINT16_MAX and shift < TCPSegment::MAX_WINDOW_SCALE) {
+      shift++;
+    }
+    return shift;
+  }
+
+  // RFC 1122 delayed ACKs: an in-order segment that leaves no gap is only acknowledged with the
+  // next one, or once cfg_.delayed_ack_ms has passed, unless a segment goes out sooner anyway.
+  // Anything else (out-of-order data, a filled gap, a SYN or FIN) is acknowledged at once, as
+  // RFC 5681 asks, so the sender learns of losses and the end of the stream without delay.
+  static constexpr unsigned SEGMENTS_PER_ACK = 2;
+  unsigned unacked_segments_{};
+  uint64_t ack_delay_elapsed_ms_{};
+
+  // Receive-buffer autotuning: time into the current sampling interval, and what the
+  // application had read when it began
+  uint64_t autotune_elapsed_ms_{};
+  uint64_t autotune_last_popped_{};
+
+  // Like Linux's receive-buffer autotuning: size the inbound stream to twice what the
+  // application consumes per round trip, so the advertised window never throttles a reader that
+  // keeps up. It only grows: shrinking could take back window the peer was already offered.
+  uint64_t autotune_interval_ms() const {
+    return std::max<uint64_t>(sender_.smoothed_RTT_ms().value_or(cfg_.recv_autotune_interval_ms),
+                              1);
+  }
+
+  void autotune_inbound_capacity(uint64_t ms_since_last_tick) {
+    if (cfg_.recv_capacity_max <= cfg_.recv_capacity or cfg_.recv_autotune_interval_ms == 0) {
+      return;
+    }
+    autotune_elapsed_ms_ += ms_since_last_tick;
+    if (autotune_elapsed_ms_ < autotune_interval_ms()) {
+      return;
+    }
+    autotune_elapsed_ms_ = 0;
+
+    const Reader &inbound = inbound_stream_.reader();
+    const uint64_t consumed = inbound.bytes_popped() - autotune_last_popped_;
+    autotune_last_popped_ = inbound.bytes_popped();
+
+    const uint64_t capacity =
+        inbound.bytes_buffered() + inbound_stream_.writer().available_capacity();
+    const uint64_t target = std::min<uint64_t>(2 * consumed, cfg_.recv_capacity_max);
+    if (target > capacity) {
+      inbound_stream_.writer().set_capacity(target);
+    }
+  }
 
  public:
   explicit TCPPeer(const TCPConfig &cfg) : cfg_(cfg) {}
@@ -26,7 +85,30 @@ class TCPPeer {
   Reader &inbound_reader() { return inbound_stream_.reader(); }
 
   void push() { sender_.push(outbound_stream_.reader()); };
-  void tick(uint64_t ms_since_last_tick) { sender_.tick(ms_since_last_tick); }
+  void tick(uint64_t ms_since_last_tick) {
+    sender_.tick(ms_since_last_tick);
+    autotune_inbound_capacity(ms_since_last_tick);
+    if (unacked_segments_ > 0) {
+      ack_delay_elapsed_ms_ += ms_since_last_tick;
+      need_send_ |= ack_delay_elapsed_ms_ >= cfg_.delayed_ack_ms;
+    }
+  }
+
+  // How many milliseconds until a tick() would have something to do, if ever
+  std::optional<uint64_t> next_timeout_ms() const {
+    std::optional<uint64_t> timeout = sender_.next_timeout_ms();
+    if (cfg_.recv_capacity_max > cfg_.recv_capacity and cfg_.recv_autotune_interval_ms > 0) {
+      const uint64_t interval_ms = autotune_interval_ms();
+      const uint64_t autotune_ms = interval_ms - std::min(autotune_elapsed_ms_, interval_ms);
+      timeout = std::min(timeout.value_or(UINT64_MAX), autotune_ms);
+    }
+    if (unacked_segments_ > 0) {
+      const uint64_t ack_ms =
+          cfg_.delayed_ack_ms - std::min(ack_delay_elapsed_ms_, cfg_.delayed_ack_ms);
+      timeout = std::min(timeout.value_or(UINT64_MAX), ack_ms);
+    }
+    return timeout;
+  }
 
   bool has_ackno() const { return receiver_.send(inbound_stream_.writer()).ackno.has_value(); }
 
@@ -44,21 +126,50 @@ class TCPPeer {
       return;
     }
 
-    // Give incoming TCPReceiverMessage to sender.
-    sender_.receive(seg.receiver_message);
+    peer_sack_permitted_ |= seg.sender_message.SYN and seg.sack_permitted;
+    if (seg.sender_message.SYN) {
+      if (cfg_.window_scaling and seg.window_scale.has_value()) {
+        peer_window_shift_ = seg.window_scale;
+        receiver_.set_window_scale(window_shift_);
+      }
+      // Segments may be as large as the smaller of the two MSSs allows: ours (the default, if we
+      // announced none) and the one the peer's SYN announced.
+      if (seg.mss.has_value()) {
+        const uint64_t our_mss = cfg_.mss > 0 ? cfg_.mss : TCPConfig::MAX_PAYLOAD_SIZE;
+        sender_.set_mss(std::min<uint64_t>(our_mss, seg.mss.value()));
+      }
+    } else if (peer_window_shift_.has_value()) {
+      seg.receiver_message.window_size <<= peer_window_shift_.value();
+    }
+
+    // Give incoming TCPReceiverMessage to sender (only a pure ACK can be a duplicate ACK).
+    sender_.receive(seg.receiver_message, seg.sender_message.sequence_length() > 0);
 
     // Give incoming TCPSenderMessage to receiver.
     // If SenderMessage is non-empty or a keep-alive, make sure to reply.
-    need_send_ |= (seg.sender_message.sequence_length() > 0);
+    const TCPSenderMessage &message = seg.sender_message;
+    const auto length = static_cast<uint32_t>(message.sequence_length());
     const auto our_ackno = receiver_.send(inbound_stream_.writer()).ackno;
-    need_send_ |= (our_ackno.has_value() and seg.sender_message.seqno + 1 == our_ackno.value());
+    need_send_ |= (our_ackno.has_value() and message.seqno + 1 == our_ackno.value());
+    const bool in_order = our_ackno.has_value() and message.seqno == our_ackno.value() and
+                          not message.SYN and not message.FIN;
 
     receiver_.receive(std::move(seg.sender_message), reassembler_, inbound_stream_.writer());
+
+    if (length > 0) {
+      const bool delayable = cfg_.delayed_ack_ms > 0 and in_order and
+                             receiver_.send(inbound_stream_.writer()).ackno ==
+                                 our_ackno.value() + length and
+                             reassembler_.bytes_pending() == 0;
+      need_send_ |= not delayable or ++unacked_segments_ >= SEGMENTS_PER_ACK;
+    }
   }
 
   std::optional<TCPSegment> maybe_send() {
-    // Get outgoing TCPReceiverMessage from receiver.
-    auto receiver_msg = receiver_.send(inbound_stream_.writer());
+    // Get outgoing TCPReceiverMessage from receiver (with SACK blocks, if both sides agreed).
+    auto receiver_msg = cfg_.sack and peer_sack_permitted_
+                            ? receiver_.send(inbound_stream_.writer(), reassembler_)
+                            : receiver_.send(inbound_stream_.writer());
 
     // If connection is alive, push stream to TCPSender.
     if (receiver_msg.ackno.has_value()) {
@@ -73,11 +184,33 @@ class TCPPeer {
     }
 
     need_send_ = false;
+    if (sender_msg.has_value()) {
+      unacked_segments_ = 0;  // It carries the ACK, so none is owed now
+      ack_delay_elapsed_ms_ = 0;
+    }
 
     // Send the segment
     if (sender_msg.has_value()) {
-      return TCPSegment{sender_msg.value(), receiver_msg,
-                        outbound_stream_.reader().has_error() or inbound_reader().has_error()};
+      TCPSegment seg{sender_msg.value(), receiver_msg,
+                     outbound_stream_.reader().has_error() or inbound_reader().has_error(),
+                     cfg_.sack and sender_msg->SYN};
+
+      // Offer window scaling in our SYN, unless it answers a SYN that didn't.
+      const bool peer_syn_seen = receiver_msg.ackno.has_value();
+      if (sender_msg->SYN) {
+        if (cfg_.window_scaling and (not peer_syn_seen or peer_window_shift_.has_value())) {
+          seg.window_scale = window_shift_;
+        }
+        if (cfg_.mss > 0) {
+          seg.mss = cfg_.mss;
+        }
+        seg.receiver_message.window_size =
+            std::min(seg.receiver_message.window_size, uint32_t{UINT16_MAX});
+      } else if (peer_window_shift_.has_value()) {
+        seg.receiver_message.window_size >>= window_shift_;
+      }
+      seg.segment_size = sender_.segment_size(sender_msg.value());
+      return seg;
     }
 
     return {};
@@ -2,7 +2,10 @@
 
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <cstddef>
 #include <optional>
+#include <span>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
@@ -14,11 +17,29 @@
  * Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
- *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    to receive, starting from the ackno if present. The TCP header's field holds at most 65,535
+ *    (UINT16_MAX from the <cstdint> header); windows beyond that need RFC 7323 window scaling,
+ *    which the TCPPeer applies when it is negotiated. In a TCPSegment, this is the header field's
+ *    value as sent on the wire.
+ *
+ * 3) Optionally, SACK blocks (RFC 2018): ranges of sequence numbers beyond the ackno that the
+ *    receiver also holds, the most recently received first. There are at most four, since that
+ *    is all the TCP option space fits.
  */
 
 struct TCPReceiverMessage {
+  // The sequence numbers [left, right)
+  struct SACKBlock {
+    Wrap32 left{0};
+    Wrap32 right{0};
+  };
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
+
   std::optional<Wrap32> ackno{};
-  uint16_t window_size{};
+  uint32_t window_size{};
+  std::array<SACKBlock, MAX_SACK_BLOCKS> sack_blocks{};
+  size_t num_sack_blocks{};
+
+  std::span<const SACKBlock> sacks() const & { return {sack_blocks.data(), num_sack_blocks}; }
+  std::span<const SACKBlock> sacks() const && = delete;  // Would dangle
 };
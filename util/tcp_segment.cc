@@ -2,9 +2,20 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <array>
 #include <cstddef>
+#include <string>
 
-static constexpr uint32_t TCPHeaderMinLen = 5;  // 32-bit words
+static constexpr uint32_t TCPHeaderMinLen = 5;   // 32-bit words
+static constexpr uint32_t TCPOptionsMaxLen = 40;  // bytes
+
+// Option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNOP = 1;
+static constexpr uint8_t TCPOptionMSS = 2;
+static constexpr uint8_t TCPOptionWindowScale = 3;
+static constexpr uint8_t TCPOptionSACKPermitted = 4;
+static constexpr uint8_t TCPOptionSACK = 5;
 
 using namespace std;
 
@@ -47,19 +58,76 @@ void TCPSegment::parse(Parser &parser, uint32_t datagram_layer_pseudo_checksum)
   sender_message.SYN = octet & 0b0000'0010;
   sender_message.FIN = octet & 0b0000'0001;
 
-  parser.integer(receiver_message.window_size);
+  parser.integer(raw16);
+  receiver_message.window_size = raw16;
   parser.integer(udinfo.cksum);
   parser.integer(raw16);  // urgent pointer
 
-  // skip any options or anything extra in the header
   if (data_offset < TCPHeaderMinLen) {
     parser.set_error();
+    return;
+  }
+  std::array<char, TCPOptionsMaxLen> options{};
+  const size_t options_len = data_offset * 4 - TCPHeaderMinLen * 4;
+  parser.string({options.data(), options_len});
+  if (parser.has_error()) {
+    return;
   }
-  parser.remove_prefix(data_offset * 4 - TCPHeaderMinLen * 4);
+  parse_options({reinterpret_cast<const uint8_t *>(options.data()), options_len});
 
   parser.all_remaining(sender_message.payload);
 }
 
+// Options this implementation doesn't know are skipped, as are malformed ones (and whatever
+// follows them).
+void TCPSegment::parse_options(span<const uint8_t> options) {
+  while (not options.empty() and options.front() != TCPOptionEnd) {
+    if (options.front() == TCPOptionNOP) {
+      options = options.subspan(1);
+      continue;
+    }
+    if (options.size() < 2 or options[1] < 2 or options[1] > options.size()) {
+      return;
+    }
+    const uint8_t kind = options[0];
+    const auto body = options.subspan(2, options[1] - 2);
+    options = options.subspan(options[1]);
+
+    auto be32 = [](span<const uint8_t> bytes) {
+      return uint32_t{bytes[0]} << 24 | uint32_t{bytes[1]} << 16 | uint32_t{bytes[2]} << 8 |
+             uint32_t{bytes[3]};
+    };
+
+    switch (kind) {
+      case TCPOptionMSS:
+        if (body.size() == 2) {
+          mss = static_cast<uint16_t>(body[0] << 8 | body[1]);
+        }
+        break;
+      case TCPOptionWindowScale:
+        if (body.size() == 1) {
+          window_scale = min(body[0], MAX_WINDOW_SCALE);  // RFC 7323: larger shifts mean 14
+        }
+        break;
+      case TCPOptionSACKPermitted:
+        sack_permitted = true;
+        break;
+      case TCPOptionSACK:
+        receiver_message.num_sack_blocks = 0;
+        for (size_t i = 0; i + 8 <= body.size(); i += 8) {
+          if (receiver_message.num_sack_blocks == TCPReceiverMessage::MAX_SACK_BLOCKS) {
+            break;
+          }
+          receiver_message.sack_blocks.at(receiver_message.num_sack_blocks++) = {
+              Wrap32{be32(body.subspan(i))}, Wrap32{be32(body.subspan(i + 4))}};
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 class Wrap32Serializable : public Wrap32 {
  public:
   uint32_t raw_value() const { return raw_value_; }
@@ -70,17 +138,63 @@ void TCPSegment::serialize(Serializer &serializer) const {
   serializer.integer(udinfo.dst_port);
   serializer.integer(Wrap32Serializable{sender_message.seqno}.raw_value());
   serializer.integer(Wrap32Serializable{receiver_message.ackno.value_or(Wrap32{0})}.raw_value());
-  serializer.integer(uint8_t{TCPHeaderMinLen << 4});  // data offset
+  serializer.integer(static_cast<uint8_t>((TCPHeaderMinLen + options_length() / 4) << 4));
   const uint8_t flags = (receiver_message.ackno.has_value() ? 0b0001'0000U : 0) |
                         (reset ? 0b0000'0100U : 0) | (sender_message.SYN ? 0b0000'0010U : 0) |
                         (sender_message.FIN ? 0b0000'0001U : 0);
   serializer.integer(flags);
-  serializer.integer(receiver_message.window_size);
+  serializer.integer(static_cast<uint16_t>(receiver_message.window_size));
   serializer.integer(udinfo.cksum);
   serializer.integer(uint16_t{0});  // urgent pointer
+  serialize_options(serializer);
   serializer.buffer(sender_message.payload);
 }
 
+// Each option is preceded by NOPs to keep it 32-bit aligned, as is customary.
+uint8_t TCPSegment::options_length() const {
+  uint8_t len = sack_permitted ? 4 : 0;
+  if (mss.has_value()) {
+    len += 4;
+  }
+  if (window_scale.has_value()) {
+    len += 4;
+  }
+  if (receiver_message.num_sack_blocks > 0) {
+    len += 4 + 8 * receiver_message.num_sack_blocks;
+  }
+  return len;
+}
+
+void TCPSegment::serialize_options(Serializer &serializer) const {
+  if (mss.has_value()) {
+    serializer.integer(TCPOptionMSS);
+    serializer.integer(uint8_t{4});
+    serializer.integer(mss.value());
+  }
+  if (window_scale.has_value()) {
+    serializer.integer(TCPOptionNOP);
+    serializer.integer(TCPOptionWindowScale);
+    serializer.integer(uint8_t{3});
+    serializer.integer(window_scale.value());
+  }
+  if (sack_permitted) {
+    serializer.integer(TCPOptionNOP);
+    serializer.integer(TCPOptionNOP);
+    serializer.integer(TCPOptionSACKPermitted);
+    serializer.integer(uint8_t{2});
+  }
+  if (receiver_message.num_sack_blocks > 0) {
+    serializer.integer(TCPOptionNOP);
+    serializer.integer(TCPOptionNOP);
+    serializer.integer(TCPOptionSACK);
+    serializer.integer(static_cast<uint8_t>(2 + 8 * receiver_message.num_sack_blocks));
+    for (const auto &block : receiver_message.sacks()) {
+      serializer.integer(Wrap32Serializable{block.left}.raw_value());
+      serializer.integer(Wrap32Serializable{block.right}.raw_value());
+    }
+  }
+}
+
 void TCPSegment::compute_checksum(uint32_t datagram_layer_pseudo_checksum) {
   udinfo.cksum = 0;
   Serializer s;
@@ -90,3 +204,42 @@ void TCPSegment::compute_checksum(uint32_t datagram_layer_pseudo_checksum) {
   check.add(s.output());
   udinfo.cksum = check.value();
 }
+
+size_t TCPSegment::header_length() const {
+  return TCPHeaderMinLen * 4 + options_length();
+}
+
+// The segments differ only in their sequence numbers, SYN and FIN flags, lengths and payloads,
+// so the rest of the header is summed once, and each segment's checksum adds its own fields to
+// that (as in RFC 1624's incremental update) rather than serializing every header again.
+vector<TCPSegment> TCPSegment::split(size_t max_payload,
+                                     uint32_t datagram_layer_pseudo_checksum) const {
+  TCPSegment common = *this;
+  common.sender_message = {};
+  common.udinfo.cksum = 0;
+  Serializer s;
+  common.serialize(s);
+  InternetChecksum common_check{datagram_layer_pseudo_checksum};
+  common_check.add(s.output());
+  const uint16_t common_sum = ~common_check.value();
+
+  const string_view payload = sender_message.payload;
+  vector<TCPSegment> segments;
+  for (size_t offset = 0; offset < payload.size() or segments.empty(); offset += max_payload) {
+    TCPSegment &segment = segments.emplace_back(common);
+    TCPSenderMessage &message = segment.sender_message;
+    message.SYN = sender_message.SYN and offset == 0;
+    message.seqno = sender_message.seqno + static_cast<uint32_t>(sender_message.SYN + offset);
+    message.payload = string{payload.substr(offset, max_payload)};
+    message.FIN = sender_message.FIN and offset + max_payload >= payload.size();
+
+    // The header is a whole number of 32-bit words, so the payload's sum starts on a word.
+    const uint32_t seqno = Wrap32Serializable{message.seqno}.raw_value();
+    InternetChecksum check{common_sum + (seqno >> 16) + (seqno & 0xffff) +
+                           (message.SYN ? 0b10U : 0) + (message.FIN ? 0b01U : 0) +
+                           static_cast<uint32_t>(header_length() + message.payload.size())};
+    check.add(message.payload);
+    segment.udinfo.cksum = check.value();
+  }
+  return segments;
+}
@@ -5,14 +5,39 @@
 #include "tcp_sender_message.hh"
 #include "udinfo.hh"
 
+#include <optional>
+#include <span>
+#include <vector>
+
 struct TCPSegment {
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;  // RFC 7323's largest shift
+
   TCPSenderMessage sender_message{};
   TCPReceiverMessage receiver_message{};
   bool reset{};  // Connection experienced an abnormal error and should be shut down
+  bool sack_permitted{};                  // SACK-permitted option (RFC 2018), only on a SYN
+  std::optional<uint8_t> window_scale{};  // Window scale option (RFC 7323), only on a SYN
+  std::optional<uint16_t> mss{};          // Maximum segment size option (RFC 9293), only on a SYN
   UserDatagramInfo udinfo{};
 
+  // Not on the wire: the payload per segment, should this be a super-segment for the adapter to
+  // split (0 for TCPConfig::MAX_PAYLOAD_SIZE)
+  size_t segment_size{};
+
   void parse(Parser &parser, uint32_t datagram_layer_pseudo_checksum);
   void serialize(Serializer &serializer) const;
 
   void compute_checksum(uint32_t datagram_layer_pseudo_checksum);
+
+  size_t header_length() const;  // In bytes, with options
+
+  // Split into segments of at most `max_payload` bytes of payload each, checksummed, as a NIC's
+  // segmentation offload would. The pseudo-header checksum is for an empty payload: each
+  // segment's own length is added to it.
+  std::vector<TCPSegment> split(size_t max_payload, uint32_t datagram_layer_pseudo_checksum) const;
+
+ private:
+  void parse_options(std::span<const uint8_t> options);
+  void serialize_options(Serializer &serializer) const;
+  uint8_t options_length() const;  // In bytes, padded to a multiple of four
 };
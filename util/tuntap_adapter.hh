@@ -23,8 +23,12 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
   //! connection
   std::optional<TCPSegment> read();
 
-  //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-  void write(TCPSegment &seg) { _tun.write(serialize(wrap_tcp_in_ip(seg))); }
+  //! Creates IPv4 datagrams from a TCP segment and writes them to the TUN device, one per write
+  void write(TCPSegment &seg) {
+    for (const auto &ip_dgram : wrap_tcp_in_ip(seg)) {
+      _tun.write(serialize(ip_dgram));
+    }
+  }
 
   //! Access the underlying TUN device
   explicit operator TunFD &() { return _tun; }